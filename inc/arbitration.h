@@ -0,0 +1,74 @@
+#ifndef ARBITRATION_H
+#define ARBITRATION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fast_random.h"
+
+// 服务员（同时拿筷子的名额）的分配策略
+enum class ArbitrationPolicy {
+    SEMAPHORE,  // 原有的 POSIX 信号量，唤醒顺序由内核决定
+    FIFO,       // 严格按到达顺序（票号式准入），等待有界
+    PRIORITY,   // 权重高者优先，同权重先来先得
+    WFQ,        // 加权公平排队（起始时间标签），按实际持有时长计费
+    DRR,        // 赤字轮转，按实际持有时长计费
+    LOTTERY     // 按权重抽签
+};
+
+std::optional<ArbitrationPolicy> parseArbitrationPolicy(const std::string& name);
+const char* arbitrationPolicyName(ArbitrationPolicy policy);
+
+// 在管理器内部按策略发放服务员名额。
+// 等待者各自在自己的条件变量上睡眠，发放名额只唤醒被选中的那一个。
+class AdmissionArbiter {
+public:
+    // weights 为空时所有座位权重为 1，否则按座位编号循环取用
+    AdmissionArbiter(ArbitrationPolicy policy, int seats, int capacity,
+                     const std::vector<double>& weights, std::uint64_t seed);
+
+    void enqueue(int seat);  // 登记等待；有空闲名额且无人排队时立即获得
+    void wait(int seat);     // 阻塞直到获得名额
+    bool waitUntil(int seat, std::chrono::steady_clock::time_point until);  // 到时仍未获得返回 false
+    bool withdraw(int seat);  // 放弃等待；名额已经发下来时返回 false，调用者需随后 release
+    void release(int seat);   // 归还名额，并按实际持有时长计费
+
+    double weightOf(int seat) const { return slots_[seat].weight; }
+
+private:
+    enum class SlotState : std::uint8_t { IDLE, WAITING, ADMITTED };
+
+    struct Slot {
+        std::condition_variable cv;
+        SlotState state = SlotState::IDLE;
+        double weight = 1.0;
+        std::uint64_t arrival = 0;  // 入队序号，用于同优先级时先来先得
+        double start_tag = 0.0;     // WFQ 起始标签
+        double finish_tag = 0.0;    // WFQ 上一次服务的结束标签
+        double deficit = 0.0;       // DRR 赤字（毫秒）
+        std::chrono::steady_clock::time_point admitted_at;
+    };
+
+    int pickNext();   // 在持锁状态下按策略选出下一个，并从等待列表移除
+    void dispatch();  // 在持锁状态下把空闲名额发给等待者
+    void removeWaiting(std::size_t index);
+
+    ArbitrationPolicy policy_;
+    int capacity_;
+    int in_use_ = 0;
+    std::mutex mutex_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<int> waiting_;  // 按到达顺序排列
+    std::size_t drr_cursor_ = 0;
+    std::uint64_t next_arrival_ = 0;
+    double virtual_time_ = 0.0;  // WFQ 系统虚拟时间
+    Pcg32 lottery_rng_;
+};
+
+#endif // ARBITRATION_H
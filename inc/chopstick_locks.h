@@ -0,0 +1,91 @@
+#ifndef CHOPSTICK_LOCKS_H
+#define CHOPSTICK_LOCKS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// 筷子锁的实现方式
+enum class ChopstickLockKind {
+    TIMED_MUTEX,  // std::timed_mutex，唤醒顺序不保证，可超时放弃
+    TICKET,       // 票号锁，严格先来先得，等待有界
+    MCS           // MCS 队列锁，先来先得，每个等待者只在自己的节点上等待
+};
+
+std::optional<ChopstickLockKind> parseChopstickLockKind(const std::string& name);
+const char* chopstickLockKindName(ChopstickLockKind kind);
+
+// 票号锁：取号后在 serving_ 上等待（C++20 atomic::wait，内核里是 futex），放锁时叫下一个号
+class alignas(64) TicketLock {
+public:
+    void lock()
+    {
+        std::uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        std::uint32_t serving = serving_.load(std::memory_order_acquire);
+        while (serving != ticket) {
+            serving_.wait(serving, std::memory_order_acquire);
+            serving = serving_.load(std::memory_order_acquire);
+        }
+    }
+
+    void unlock()
+    {
+        serving_.fetch_add(1, std::memory_order_release);
+        serving_.notify_all();  // 同一根筷子的等待者只有它的几个使用者
+    }
+
+private:
+    std::atomic<std::uint32_t> next_{0};
+    std::atomic<std::uint32_t> serving_{0};
+};
+
+// MCS 队列节点：每个等待者一个，独占缓存行
+struct alignas(64) McsNode {
+    std::atomic<McsNode*> next{nullptr};
+    std::atomic<bool> locked{false};
+};
+
+// MCS 队列锁：锁本身只有一个尾指针；等待者排成链表，各自在自己的节点上先短暂自旋再睡眠，
+// 放锁时只写后继节点的一个缓存行，等待者之间不会争抢同一行
+class alignas(64) McsLock {
+public:
+    void lock(McsNode& node);
+    void unlock(McsNode& node);
+
+private:
+    std::atomic<McsNode*> tail_{nullptr};
+};
+
+// 管理器持有的全部筷子锁。每把锁单独分配，便于按 NUMA 节点首次触碰放置。
+// slot 是 (座位, 第几根筷子) 在冲突图邻接数组中的下标，供需要每等待者节点的锁使用。
+class ChopstickLocks {
+public:
+    // slots 为等待者槽位总数（冲突图邻接数组长度），只有 MCS 用到
+    ChopstickLocks(ChopstickLockKind kind, int count, std::size_t slots);
+
+    ChopstickLockKind kind() const { return kind_; }
+    // 只有互斥锁能中途放弃等待；票号和 MCS 排上队后撤不出来，否则后面的号或节点永远等不到交接
+    bool abandonable() const { return kind_ == ChopstickLockKind::TIMED_MUTEX; }
+
+    void lock(int chopstick, std::size_t slot);
+    // 在 until 前拿不到返回 false；只能用于 abandonable() 的锁
+    bool tryLockUntil(int chopstick, std::chrono::steady_clock::time_point until);
+    void unlock(int chopstick, std::size_t slot);
+
+    void place(int chopstick);  // 在调用线程所在节点上重新分配这把锁，只能在开始进餐前调用
+
+private:
+    ChopstickLockKind kind_;
+    std::vector<std::unique_ptr<std::timed_mutex>> mutexes_;
+    std::vector<std::unique_ptr<TicketLock>> tickets_;
+    std::vector<std::unique_ptr<McsLock>> mcs_;
+    std::unique_ptr<McsNode[]> nodes_;
+};
+
+#endif // CHOPSTICK_LOCKS_H
@@ -0,0 +1,62 @@
+#ifndef CHOPSTICK_RENDERER_H
+#define CHOPSTICK_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// 实例化绘制筷子，缓动在顶点着色器里完成。
+// 座位坐标和每根筷子的静止位置只在构造时上传一次；之后每根筷子只有
+// （起点，持有者，变化时刻）一条 16 字节的实例数据，持有者变化时才改写，
+// 每帧 CPU 开销与变化次数成正比，而不是与筷子数成正比。
+class ChopstickRenderer {
+public:
+    // seats：各座位中心；rest：各筷子无人持有时的位置，两者按编号一一对应
+    ChopstickRenderer(const std::string& vertex_path, const std::string& fragment_path,
+                      std::span<const glm::vec2> seats, std::span<const glm::vec2> rest,
+                      glm::vec2 half_size, glm::vec4 color);
+    ~ChopstickRenderer();
+
+    ChopstickRenderer(const ChopstickRenderer&) = delete;
+    ChopstickRenderer& operator=(const ChopstickRenderer&) = delete;
+
+    // 持有者变化时调用，now 为秒；未变化时什么也不做
+    void setOwner(int chopstick, int owner, float now);
+    void draw(const glm::mat4& projection, float now);
+
+    bool animating(float now) const { return now < settle_time_; }  // 是否还有筷子在移动
+    int count() const { return static_cast<int>(instances_.size()); }
+
+private:
+    struct Instance {
+        float from_x, from_y;  // 变化时刻的位置，缓动从这里出发
+        float start;           // 变化时刻（秒）
+        std::int32_t owner;    // -1 表示放回原位
+    };
+
+    glm::vec2 target(int chopstick, int owner) const;
+    glm::vec2 positionAt(int chopstick, float now) const;  // 与着色器相同的缓动公式
+
+    GLuint program_ = 0;
+    GLint projection_location_ = -1;
+    GLint time_location_ = -1;
+    GLuint vao_ = 0;
+    GLuint quad_vbo_ = 0;
+    GLuint rest_vbo_ = 0;
+    GLuint instance_vbo_ = 0;
+    GLuint seat_buffer_ = 0;
+    GLuint seat_texture_ = 0;
+
+    std::vector<glm::vec2> seats_;
+    std::vector<glm::vec2> rest_;
+    std::vector<Instance> instances_;  // GPU 实例缓冲的 CPU 镜像
+    int dirty_begin_ = 0;              // 待上传的实例区间 [dirty_begin_, dirty_end_)
+    int dirty_end_ = 0;
+    float settle_time_ = 0.0f;         // 最后一次变化的缓动结束时刻
+};
+
+#endif // CHOPSTICK_RENDERER_H
@@ -0,0 +1,52 @@
+#ifndef COMPACT_SEATS_H
+#define COMPACT_SEATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fast_random.h"
+
+// 面向百万级座位的紧凑状态：按列存储（SoA），每个座位 12 字节。
+// packed_ 的低 2 位是状态，高 30 位是进餐次数；
+// rng_ 是每个座位独立的 PCG32，结果与座位如何分段无关。
+class CompactSeatTable {
+public:
+    CompactSeatTable(std::size_t seats, std::uint64_t seed)
+        : packed_(seats, 0)
+    {
+        rng_.reserve(seats);
+        for (std::size_t seat = 0; seat < seats; ++seat) {
+            rng_.emplace_back(mixSeed(seed ^ (static_cast<std::uint64_t>(seat) << 1)));
+        }
+    }
+
+    std::size_t size() const { return packed_.size(); }
+
+    std::uint8_t state(std::size_t seat) const { return packed_[seat] & kStateMask; }
+    void setState(std::size_t seat, std::uint8_t state)
+    {
+        packed_[seat] = (packed_[seat] & ~kStateMask) | (state & kStateMask);
+    }
+
+    std::uint32_t eatCount(std::size_t seat) const { return packed_[seat] >> kCountShift; }
+    void addMeal(std::size_t seat)
+    {
+        if (eatCount(seat) < kMaxCount)
+            packed_[seat] += 1u << kCountShift;
+    }
+
+    Pcg32& rng(std::size_t seat) { return rng_[seat]; }
+
+    static constexpr std::size_t bytesPerSeat() { return sizeof(std::uint32_t) + sizeof(Pcg32); }
+
+private:
+    static constexpr std::uint32_t kStateMask = 0x3u;
+    static constexpr int kCountShift = 2;
+    static constexpr std::uint32_t kMaxCount = (1u << (32 - kCountShift)) - 1;
+
+    std::vector<std::uint32_t> packed_;
+    std::vector<Pcg32> rng_;
+};
+
+#endif // COMPACT_SEATS_H
@@ -0,0 +1,126 @@
+#ifndef CORO_SCHEDULER_H
+#define CORO_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "timer_wheel.h"
+
+// 哲学家协程的返回类型：创建后挂起，由调度器负责恢复，析构时销毁协程帧
+class CoroTask {
+public:
+    struct promise_type {
+        CoroTask get_return_object()
+        {
+            return CoroTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    CoroTask() = default;
+    explicit CoroTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    CoroTask(CoroTask&& other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+    CoroTask& operator=(CoroTask&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    ~CoroTask()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    CoroTask(const CoroTask&) = delete;
+    CoroTask& operator=(const CoroTask&) = delete;
+
+    std::coroutine_handle<promise_type> handle() const { return handle_; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 单线程协程调度器：思考/进餐是定时器等待，拿筷子是筷子等待，
+// 一个内核线程即可驱动整张桌子
+class CoroScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerQueue = TimerWheel<std::coroutine_handle<>>;
+
+    // chopstick_owner 即管理器的筷子持有表，-1 表示空闲，调度器直接在上面登记；
+    // timers 是管理器持有的时间轮，所有思考/进餐的到期都登记在上面
+    CoroScheduler(std::vector<std::atomic<int>>& chopstick_owner, TimerQueue& timers);
+    ~CoroScheduler();
+
+    CoroScheduler(const CoroScheduler&) = delete;
+    CoroScheduler& operator=(const CoroScheduler&) = delete;
+
+    // 定时器等待：到期前不占用线程
+    struct SleepAwaiter {
+        CoroScheduler& scheduler;
+        Clock::time_point deadline;
+
+        bool await_ready() const { return deadline <= Clock::now(); }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler.addTimer(deadline, handle); }
+        void await_resume() const {}
+    };
+
+    // 筷子等待：所需筷子全部空闲才一起拿起，否则挂起排队，不会持有并等待
+    struct ChopstickAwaiter {
+        CoroScheduler& scheduler;
+        int owner;
+        std::span<const int> chopsticks;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() { return scheduler.tryTake(owner, chopsticks); }
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            handle = h;
+            scheduler.enqueueWaiter(this);
+        }
+        void await_resume() const {}
+    };
+
+    void spawn(CoroTask task);  // 登记协程并放入就绪队列
+    SleepAwaiter sleepFor(std::chrono::milliseconds duration);
+    ChopstickAwaiter acquireChopsticks(int owner, std::span<const int> chopsticks);
+    void releaseChopsticks(std::span<const int> chopsticks);  // 放下筷子并唤醒可以进餐的邻居
+
+    void run();          // 在当前线程上驱动所有协程，直到 requestStop
+    void requestStop();  // 可从其他线程调用，立即打断定时器等待
+
+private:
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> handle);
+    bool tryTake(int owner, std::span<const int> chopsticks);
+    void enqueueWaiter(ChopstickAwaiter* waiter);
+    void wakeWaiters(int chopstick);
+    void removeWaiter(int chopstick, ChopstickAwaiter* waiter);
+    bool isFree(int chopstick) const;
+
+    std::vector<std::atomic<int>>& chopstick_owner_;
+    std::vector<std::vector<ChopstickAwaiter*>> waiters_;  // 每根筷子上排队的协程
+    std::vector<CoroTask> tasks_;
+    std::deque<std::coroutine_handle<>> ready_;
+    TimerQueue& timers_;
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_requested_;
+};
+
+#endif // CORO_SCHEDULER_H
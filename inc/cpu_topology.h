@@ -0,0 +1,25 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <vector>
+
+// 单个逻辑 CPU 的拓扑信息（来自 /sys/devices/system）
+struct CpuInfo {
+    int cpu;      // 逻辑 CPU 编号
+    int core;     // 物理核编号（同核的超线程共享 L1/L2）
+    int package;  // 插槽编号
+    int node;     // NUMA 节点编号，没有 NUMA 信息时等于插槽编号
+};
+
+// 读取当前进程可用 CPU 的拓扑，按 (node, package, core, cpu) 排序，
+// 相邻元素尽量共享同一个核 / 插槽 / NUMA 节点
+std::vector<CpuInfo> detectCpuTopology();
+
+// 为 num_seats 个座位分配 CPU：座位数不超过 CPU 数时紧密排布，
+// 否则连续的一段座位共用一个 CPU，保证相邻座位落在拓扑上相邻的 CPU
+std::vector<int> assignSeatCpus(const std::vector<CpuInfo>& topology, int num_seats);
+
+bool pinCurrentThread(int cpu);  // 把当前线程绑定到指定 CPU
+int currentNumaNode();           // 当前线程所在的 NUMA 节点，未知时返回 -1
+
+#endif // CPU_TOPOLOGY_H
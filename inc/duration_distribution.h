@@ -0,0 +1,94 @@
+#ifndef DURATION_DISTRIBUTION_H
+#define DURATION_DISTRIBUTION_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "trace_file.h"
+
+// 思考/进餐时长分布，内部单位为微秒。
+// 均匀分布直接做乘法移位；指数、对数正态、经验和直方图分布预先算好 4096 个分位点，
+// 采样只是用随机数高 12 位查表，热路径里没有 log/exp，也不依赖具体随机数引擎。
+// 记录回放（TRACE）不抽样，而是按游标顺序读取映射的记录文件。
+class DurationDistribution {
+public:
+    enum class Kind { UNIFORM, EXPONENTIAL, LOGNORMAL, EMPIRICAL, TRACE };
+    using Cursor = std::size_t;  // 回放游标，非回放分布忽略
+
+    static DurationDistribution uniform(int min_ms, int max_ms);
+    static DurationDistribution exponential(double mean_ms, double min_ms = 0.0);
+    static DurationDistribution lognormal(double median_ms, double sigma);
+    // 从文本文件读取样本（毫秒，空白分隔，# 开头为注释），失败时返回 nullopt
+    static std::optional<DurationDistribution> empirical(const std::string& path);
+    static DurationDistribution empirical(std::vector<double> samples_ms);
+    // 直方图文件：每行 "桶上界毫秒 次数"，桶下界为上一行的上界（第一行为 0），桶内按均匀分布插值
+    static std::optional<DurationDistribution> histogram(const std::string& path);
+    // 按顺序回放记录文件（见 MappedTrace），失败时返回 nullopt
+    static std::optional<DurationDistribution> trace(const std::string& path);
+
+    // 解析 "uniform:MIN:MAX"、"exp:MEAN[:MIN]"、"lognormal:MEDIAN:SIGMA"、"file:PATH"、
+    // "hist:PATH"、"trace:PATH"，单位毫秒
+    static std::optional<DurationDistribution> parse(const std::string& spec);
+
+    DurationDistribution scaled(double factor) const;  // 所有时长乘以 factor
+
+    // r 为 32 位均匀随机数；回放分布没有可抽样的形状，只能通过下面带游标的接口使用
+    std::uint32_t sampleMicros(std::uint32_t r) const
+    {
+        if (!table_)
+            return min_us_ + static_cast<std::uint32_t>((static_cast<std::uint64_t>(r) * span_us_) >> 32);
+        return (*table_)[r >> (32 - kTableBits)];
+    }
+
+    // 批量采样：randoms 与 out 等长，循环体无分支，可被编译器向量化
+    void sampleMicros(std::span<const std::uint32_t> randoms, std::span<std::uint32_t> out) const;
+
+    // 与标准分布相同的调用方式，任何输出 32 位的随机数引擎都可以接入；返回毫秒
+    template <typename Engine>
+    int operator()(Engine& engine) const
+    {
+        return static_cast<int>((sampleMicros(static_cast<std::uint32_t>(engine())) + 500) / 1000);
+    }
+
+    // 回放分布从 cursor 处取下一条记录，其他分布照常抽样
+    std::uint32_t nextMicros(std::uint32_t r, Cursor& cursor) const
+    {
+        if (!trace_)
+            return sampleMicros(r);
+        return static_cast<std::uint32_t>(trace_->next(cursor) * trace_scale_);
+    }
+
+    template <typename Engine>
+    int operator()(Engine& engine, Cursor& cursor) const
+    {
+        return static_cast<int>((nextMicros(static_cast<std::uint32_t>(engine()), cursor) + 500) / 1000);
+    }
+
+    bool isTrace() const { return trace_ != nullptr; }
+    Cursor startCursor(int seat, int seats) const { return trace_ ? trace_->startCursor(seat, seats) : 0; }
+
+    Kind kind() const { return kind_; }
+    std::uint32_t minMicros() const;
+    std::string describe() const;
+
+private:
+    static constexpr int kTableBits = 12;
+    static constexpr std::size_t kTableSize = std::size_t{1} << kTableBits;
+
+    template <typename Quantile>
+    static DurationDistribution fromQuantile(Kind kind, std::string description, Quantile quantile);
+
+    Kind kind_ = Kind::UNIFORM;
+    std::uint32_t min_us_ = 0;
+    std::uint64_t span_us_ = 1;  // 均匀分布的取值个数
+    std::shared_ptr<const std::vector<std::uint32_t>> table_;  // 分位点表，多个哲学家共享
+    std::shared_ptr<const MappedTrace> trace_;                 // 回放的记录文件
+    double trace_scale_ = 1.0;
+    std::string description_;
+};
+
+#endif // DURATION_DISTRIBUTION_H
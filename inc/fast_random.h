@@ -0,0 +1,106 @@
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// PCG32（XSH-RR 64/32，固定增量）：只有 8 字节状态，满足 UniformRandomBitGenerator，
+// 可以直接替代 std::mt19937（约 5 KB）交给标准分布使用
+class Pcg32 {
+public:
+    using result_type = std::uint32_t;
+
+    explicit Pcg32(std::uint64_t seed = 0x853C49E6748FEA9Bull)
+        : state_(0)
+    {
+        (*this)();
+        state_ += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        std::uint64_t old = state_;
+        state_ = old * 6364136223846793005ull + kIncrement;
+        auto xorshifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+        auto rot = static_cast<std::uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31u));
+    }
+
+    // [0, range) 内的整数，乘法移位映射，偏差不超过 range / 2^32
+    std::uint32_t bounded(std::uint32_t range)
+    {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>((*this)()) * range) >> 32);
+    }
+
+    // [0, 1) 内的浮点数
+    double uniform01() { return (*this)() * (1.0 / 4294967296.0); }
+
+private:
+    static constexpr std::uint64_t kIncrement = 1442695040888963407ull;
+    std::uint64_t state_;
+};
+
+// xoshiro128++：16 字节状态，只用移位、异或和加法。
+// fill() 一次生成一批，状态留在寄存器里，适合批量采样的场合
+class Xoshiro128pp {
+public:
+    using result_type = std::uint32_t;
+
+    explicit Xoshiro128pp(std::uint64_t seed = 1);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        std::uint32_t result = rotl(s_[0] + s_[3], 7) + s_[0];
+        std::uint32_t t = s_[1] << 9;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 11);
+        return result;
+    }
+
+    void fill(std::span<std::uint32_t> out)
+    {
+        Xoshiro128pp local = *this;
+        for (std::uint32_t& value : out) {
+            value = local();
+        }
+        *this = local;
+    }
+
+private:
+    static std::uint32_t rotl(std::uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    std::uint32_t s_[4];
+};
+
+// splitmix64：把连续的编号打散成互不相关的种子
+inline std::uint64_t mixSeed(std::uint64_t value)
+{
+    std::uint64_t z = value + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline Xoshiro128pp::Xoshiro128pp(std::uint64_t seed)
+{
+    std::uint64_t a = mixSeed(seed);
+    std::uint64_t b = mixSeed(a);
+    s_[0] = static_cast<std::uint32_t>(a);
+    s_[1] = static_cast<std::uint32_t>(a >> 32);
+    s_[2] = static_cast<std::uint32_t>(b);
+    s_[3] = static_cast<std::uint32_t>(b >> 32) | 1u;  // 状态不能全为零
+}
+
+#endif // FAST_RANDOM_H
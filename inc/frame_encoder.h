@@ -0,0 +1,78 @@
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 后台编码线程：渲染线程把读回的帧交进有界队列就返回，文件写入和 PNG 打包都在后台完成。
+// 输出为 "-" 时向标准输出写原始 RGBA 流，以 .png 结尾时写图像序列
+// （路径里可以有一个 %d 或 %05d 这样的编号占位，没有时在扩展名前加 _00000；其他 % 用法一律拒绝），
+// 其余路径写原始 RGBA 文件。
+class FrameEncoder {
+public:
+    static std::unique_ptr<FrameEncoder> open(const std::string& output, int queue_depth = 8);  // 失败时返回空
+    ~FrameEncoder();  // 写完队列里剩下的帧再退出
+
+    FrameEncoder(const FrameEncoder&) = delete;
+    FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+    // 交出一帧（行序自上而下的 RGBA）。rgba 与队列里回收的缓冲交换，调用方可直接复用它，不必重新分配。
+    // 队列满时 wait 为 false 则丢弃这一帧并返回 false，交互窗口录制因此永不阻塞
+    bool submit(std::vector<std::uint8_t>& rgba, int width, int height, bool wait);
+    void finish();  // 写完已交出的帧并结束编码线程，之后不再接受新帧
+
+    bool failed() const { return failed_; }  // 写出出错后不再接受新帧
+    std::uint64_t written() const { return written_; }
+    std::uint64_t dropped() const { return dropped_; }
+    bool isSequence() const { return sequence_.digits > 0; }
+
+private:
+    struct Frame {
+        std::vector<std::uint8_t> rgba;
+        int width = 0;
+        int height = 0;
+    };
+
+    // 图像序列的文件名：前缀 + 补零到 digits 位的帧号 + 后缀；digits 为 0 表示不是图像序列
+    struct SequenceName {
+        std::string prefix;
+        int digits = 0;
+        std::string suffix;
+    };
+
+    FrameEncoder(std::FILE* stream, SequenceName sequence, int queue_depth);
+
+    void encodeLoop();
+    bool encode(const Frame& frame);
+
+    std::FILE* stream_;    // 原始流输出，图像序列时为空
+    SequenceName sequence_;
+    std::size_t queue_depth_;
+
+    std::mutex mutex_;                // 保护以下队列与 stop_
+    std::condition_variable ready_;   // 有新帧或要退出
+    std::condition_variable space_;   // 队列有空位
+    std::deque<Frame> queue_;
+    std::vector<std::vector<std::uint8_t>> free_;  // 写完的缓冲，交还给渲染线程复用
+    bool stop_ = false;
+
+    std::atomic<bool> failed_{false};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    // 以下只由编码线程使用
+    int first_width_ = 0;  // 原始流的帧尺寸中途变了只提醒一次
+    int first_height_ = 0;
+    bool size_warned_ = false;
+    std::vector<std::uint8_t> png_;  // PNG 数据块暂存，跨帧复用
+    std::thread thread_;
+};
+
+#endif // FRAME_ENCODER_H
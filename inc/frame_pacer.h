@@ -0,0 +1,39 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+// 每秒汇总一次的帧统计
+struct FrameStats {
+    double fps = 0.0;           // 实际绘制的帧率
+    double skipped_fps = 0.0;   // 因画面静止而跳过的帧率
+    double cpu_percent = 0.0;   // 渲染线程占用一个核的百分比
+    double saved_percent = 0.0; // 相对于空转满一个核节省的百分比
+    double frame_ms = 0.0;      // 绘制一帧（从开始绘制到交换缓冲返回）的平均耗时
+};
+
+// 帧率上限与渲染线程 CPU 统计。只负责计算该等多久，真正的等待由调用方
+// 交给 glfwWaitEventsTimeout，这样等待期间输入事件仍能及时处理。
+class FramePacer {
+public:
+    explicit FramePacer(double target_fps);  // 0 表示不限帧率
+
+    double untilNextFrame(double now) const;  // 距下一帧允许开始的秒数，不需要等待时为 0
+    double idleWait() const;                  // 画面静止时每次等待事件的最长秒数
+    void frameRendered(double now, double frame_seconds);  // frame_seconds：本帧绘制耗时
+    void frameSkipped();
+
+    // 距上次汇总满一秒时写入 stats 并返回 true
+    bool sample(double now, FrameStats& stats);
+
+private:
+    static double threadCpuSeconds();
+
+    double interval_;            // 目标帧间隔，0 表示不限
+    double next_frame_ = 0.0;
+    double window_start_;        // 当前统计窗口的起点（墙钟秒）
+    double window_cpu_start_;    // 当前统计窗口起点的线程 CPU 秒
+    int rendered_ = 0;
+    double frame_seconds_ = 0.0;  // 本窗口内各帧绘制耗时之和
+    int skipped_ = 0;
+};
+
+#endif // FRAME_PACER_H
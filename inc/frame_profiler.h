@@ -0,0 +1,96 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 渲染循环的分段计时：每段记录 CPU 墙钟耗时，GPU 段另外用 GL_TIME_ELAPSED 查询。
+// 查询对象按帧组成环形池，结果在几帧之后非阻塞地取回，不会让 CPU 等 GPU；
+// 到复用时结果仍未就绪的样本直接丢弃。各段保留最近 kWindow 个样本的均值和最大值。
+// GPU 段不能嵌套（同一时刻只能有一个 GL_TIME_ELAPSED 查询），CPU 段可以包住 GPU 段。
+class FrameProfiler {
+public:
+    struct PassStats {
+        std::string name;
+        bool gpu = false;
+        double cpu_mean_ms = 0.0;
+        double cpu_max_ms = 0.0;
+        double gpu_mean_ms = 0.0;
+        double gpu_max_ms = 0.0;
+    };
+
+    // 在作用域内计时一段
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, int pass) : profiler_(profiler), pass_(pass) { profiler_.beginPass(pass_); }
+        ~Scope() { profiler_.endPass(pass_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler& profiler_;
+        int pass_;
+    };
+
+    FrameProfiler() = default;
+    ~FrameProfiler();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    int addPass(const std::string& name, bool gpu);  // 在第一帧之前登记，返回段编号
+    bool openCsv(const std::string& path);           // 之后每个取回的样本写一行
+
+    void beginFrame();  // 每轮循环开头调用：回收最旧一帧的查询结果并复用其槽位
+    void beginPass(int pass);
+    void endPass(int pass);
+
+    std::vector<PassStats> stats() const;
+    std::string summary() const;  // 供 HUD 显示的多行文本
+
+private:
+    static constexpr int kLatency = 4;    // 查询结果最多等几帧
+    static constexpr int kWindow = 120;   // 滚动统计的样本数
+
+    struct Sample {
+        bool ran = false;
+        double cpu_ms = 0.0;
+        GLuint query = 0;
+        bool query_issued = false;
+    };
+
+    struct Rolling {
+        std::array<double, kWindow> values{};
+        int count = 0;
+        int next = 0;
+
+        void add(double value);
+        double mean() const;
+        double max() const;
+    };
+
+    struct Pass {
+        std::string name;
+        bool gpu;
+        Rolling cpu;
+        Rolling gpu_time;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    void collect(int slot);
+
+    std::vector<Pass> passes_;
+    std::array<std::vector<Sample>, kLatency> slots_;  // 每个槽位是一帧，按段编号索引
+    std::array<long long, kLatency> slot_frame_{};
+    int slot_ = -1;
+    long long frame_ = -1;
+    long long dropped_ = 0;  // 复用时结果仍未就绪而丢弃的 GPU 样本数
+    std::ofstream csv_;
+};
+
+#endif // FRAME_PROFILER_H
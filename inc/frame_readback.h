@@ -0,0 +1,39 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+// 异步读回帧缓冲：glReadPixels 写进像素缓冲对象（PBO）后立即返回，
+// 每帧插一个 fence；几帧之后 GPU 早已完成时再映射 PBO 取数据，渲染线程不必等待。
+// 环里的 PBO 全部在途时 capture 会先取回最旧的一帧。
+class FrameReadback {
+public:
+    FrameReadback(int width, int height, int depth = 3);
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    // 读当前读帧缓冲的左下角 width x height；环已满时返回 false，需要先 retrieve
+    bool capture();
+    // 取回最旧的在途帧，行序自上而下的 RGBA。wait 为 false 且 GPU 尚未完成时返回 false
+    bool retrieve(std::vector<std::uint8_t>& rgba, bool wait);
+
+    int pending() const { return pending_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    std::size_t frameBytes() const { return static_cast<std::size_t>(width_) * height_ * 4; }
+
+private:
+    int width_;
+    int height_;
+    std::vector<GLuint> buffers_;
+    std::vector<GLsync> fences_;
+    int head_ = 0;     // 下一次写入的 PBO
+    int pending_ = 0;  // 在途帧数，最旧的一帧是 head_ - pending_
+};
+
+#endif // FRAME_READBACK_H
@@ -0,0 +1,50 @@
+#ifndef HEAT_MAP_H
+#define HEAT_MAP_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// 座位 × 时间热力图。纹理每列是一个采样时刻、每行是一组相邻座位，
+// 按环形缓冲使用：每次 push 只用 glTexSubImage2D 改写最旧的一列，
+// 着色器按写入位置平移纹理坐标，最新一列总在最右边。
+// 座位多于 max_rows 时相邻座位合并成一行取平均，纹理高度不受座位数限制。
+class HeatMap {
+public:
+    HeatMap(const std::string& vertex_path, const std::string& fragment_path, int seats,
+            int columns = 256, int max_rows = 1024);
+    ~HeatMap();
+
+    HeatMap(const HeatMap&) = delete;
+    HeatMap& operator=(const HeatMap&) = delete;
+
+    // 追加一列，values 为每座位的取值，按 [0, 1] 截断后着色
+    void push(std::span<const float> values);
+    // 画在归一化坐标矩形 [lower, upper] 内，座位 0 在上
+    void draw(const glm::mat4& projection, glm::vec2 lower, glm::vec2 upper);
+
+    int rows() const { return rows_; }
+    int columns() const { return columns_; }
+
+private:
+    GLuint program_ = 0;
+    GLint projection_location_ = -1;
+    GLint rect_location_ = -1;
+    GLint head_location_ = -1;
+    GLuint vao_ = 0;
+    GLuint vbo_ = 0;
+    GLuint texture_ = 0;
+
+    int seats_;
+    int columns_;
+    int rows_;
+    int head_ = 0;  // 下一次写入的列
+    std::vector<float> row_sum_;
+    std::vector<std::uint8_t> column_;
+};
+
+#endif // HEAT_MAP_H
@@ -0,0 +1,39 @@
+#ifndef OFFSCREEN_CONTEXT_H
+#define OFFSCREEN_CONTEXT_H
+
+#include <glad/glad.h>
+
+#include <memory>
+
+// 无窗口的 OpenGL 3.3 core 上下文（EGL），用于没有显示器的服务器上录制画面。
+// 优先使用 Mesa 的 surfaceless 平台（llvmpipe 即可），否则退回默认显示加 pbuffer。
+// 渲染目标是一个 RGBA8 帧缓冲对象，不依赖窗口系统的默认帧缓冲。
+// 只在找到 EGL 时编译（HAVE_EGL）。
+class OffscreenContext {
+public:
+    static std::unique_ptr<OffscreenContext> create(int width, int height);  // 失败时返回空
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    static void* procAddress(const char* name);  // 交给 gladLoadGLLoader
+
+    bool createFramebuffer();  // GL 函数加载之后调用
+    void bind() const;         // 绑定离屏帧缓冲为读写目标，每帧绘制前调用
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    OffscreenContext(int width, int height) : width_(width), height_(height) {}
+
+    int width_;
+    int height_;
+    void* display_ = nullptr;  // EGLDisplay 等句柄，头文件里不引入 EGL
+    void* surface_ = nullptr;
+    void* context_ = nullptr;
+    GLuint framebuffer_ = 0;
+    GLuint color_ = 0;
+};
+
+#endif // OFFSCREEN_CONTEXT_H
@@ -0,0 +1,130 @@
+#ifndef PARALLEL_DES_H
+#define PARALLEL_DES_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "compact_seats.h"
+#include "duration_distribution.h"
+#include "resource_topology.h"
+
+// 虚拟时间模拟参数，时长单位为毫秒
+struct DesOptions {
+    std::int64_t num_seats = 5;
+    // 分段数，每段一个线程。前瞻量取最短思考/进餐时长，为 0 时（如回放记录文件）无法分段，只用一个线程
+    int partitions = 1;
+    double virtual_seconds = 60.0;  // 模拟的虚拟时长
+    DurationDistribution think = DurationDistribution::uniform(1000, 5000);  // 与 Philosopher 相同的默认分布
+    DurationDistribution eat = DurationDistribution::uniform(1000, 3000);
+    std::uint64_t seed = 1;
+    std::shared_ptr<const ResourceTopology> topology;  // 为空时使用 num_seats 个座位的环形桌
+};
+
+struct DesResult {
+    std::vector<std::uint32_t> eat_counts;  // 每个座位的进餐次数
+    std::uint64_t meals = 0;
+    std::uint64_t events = 0;               // 处理的事件总数
+    std::uint64_t windows = 0;              // 同步窗口数
+    std::uint64_t exposed_events = 0;       // 靠近分段交界、需要跨段排序的事件数
+    std::uint64_t stalls = 0;               // 交界事件等待其他分段的次数
+    int partitions = 1;                     // 实际使用的分段数
+    double wall_seconds = 0.0;
+    std::size_t seat_bytes = 0;             // 每座位常驻状态字节数（不含事件队列）
+};
+
+// 保守式并行离散事件模拟，结果与单分段的顺序模拟逐座位相同。
+// 座位按编号连续区段分给各线程。每个事件产生的新事件至少晚一个前瞻量 L（最短思考/进餐时长），
+// 所以从全局最早事件时刻 T 起的窗口 [T, T + L) 内的事件在窗口开始时就已确定，各段可以并行处理。
+// 处理座位 s 的事件会读写 s 和它邻座的状态与筷子，距离 3 以内有外段座位的事件因此可能与外段冲突：
+// 这些交界事件按 (时间, 座位) 的全局顺序依次执行，每段公布自己下一个未处理事件的时刻，
+// 交界事件等到其他各段都越过它之后才处理；其余事件只与本段冲突，按本段顺序处理即可。
+// 交界事件叫醒外段座位时，新事件先放进本段发件箱，窗口结束时在屏障完成函数里交给所属分段。
+class ParallelDesSimulation {
+public:
+    explicit ParallelDesSimulation(const DesOptions& options);
+
+    DesResult run();
+
+private:
+    enum SeatState : std::uint8_t { THINKING, HUNGRY, EATING };
+    enum EventType : std::uint8_t { THINK_DONE, EAT_DONE };
+
+    // 16 字节：座位编号与资源拓扑一致用 32 位
+    struct Event {
+        std::uint64_t time;  // 虚拟微秒
+        std::int32_t seat;
+        EventType type;
+
+        Event(std::uint64_t t, std::int64_t s, EventType k)
+            : time(t), seat(static_cast<std::int32_t>(s)), type(k)
+        {
+        }
+
+        // 每个座位同时至多有一个未处理事件，(时间, 座位) 就是全序
+        bool operator>(const Event& other) const
+        {
+            if (time != other.time)
+                return time > other.time;
+            return seat > other.seat;
+        }
+    };
+
+    struct Partition {
+        std::int64_t begin;
+        std::int64_t end;
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+        std::vector<Event> outbox;  // 本窗口内给外段座位安排的事件，都不早于窗口结束
+        std::uint64_t processed = 0;
+        std::uint64_t exposed = 0;
+        std::uint64_t stalls = 0;
+    };
+
+    // 每段下一个未处理事件的时刻，处理完本窗口后为窗口结束时刻；各占一条缓存行
+    struct alignas(64) Frontier {
+        std::atomic<std::uint64_t> time{0};
+    };
+
+    void processWindow(int index);
+    void completeWindow();  // 屏障完成函数：投递发件箱并计算下一个窗口
+    void waitForTurn(int index, const Event& event);
+    void publishFrontier(int index);
+    void tryEat(int index, std::int64_t seat, std::uint64_t now);
+    void wakeNeighbours(int index, int chopstick, std::int64_t releaser, std::uint64_t now);
+    bool allFree(std::int64_t seat) const;
+    void startEating(int index, std::int64_t seat, std::uint64_t now);
+    void markExposedSeats();
+
+    std::span<const int> chopsticksOf(std::int64_t seat) const
+    {
+        return topology_->resourcesOf(static_cast<int>(seat));
+    }
+    int partitionOf(std::int64_t seat) const;
+    std::uint64_t sample(std::int64_t seat, const DurationDistribution& distribution,
+                         std::vector<DurationDistribution::Cursor>& cursors);
+
+    DesOptions options_;
+    std::shared_ptr<const ResourceTopology> topology_;
+    std::int64_t num_seats_;
+    std::uint64_t end_time_;
+    std::uint64_t lookahead_;
+
+    // 每座位状态：状态和进餐次数压进一个字，外加 8 字节随机数状态
+    CompactSeatTable seats_;
+    // 回放记录文件时每座位的读取位置，非回放分布时为空
+    std::vector<DurationDistribution::Cursor> think_cursor_;
+    std::vector<DurationDistribution::Cursor> eat_cursor_;
+
+    std::vector<std::int32_t> chopstick_owner_;  // -1 表示空闲
+    std::vector<std::uint8_t> exposed_;         // 座位距离 3 以内是否有外段座位，单分段时为空
+
+    std::vector<Partition> partitions_;
+    std::vector<Frontier> frontier_;
+    std::uint64_t window_end_;
+    std::uint64_t windows_;
+    bool done_;
+};
+
+#endif // PARALLEL_DES_H
@@ -3,6 +3,7 @@
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <vector>
 #include <random>
@@ -10,8 +11,73 @@
 #include <memory>
 #include <utility>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <coroutine>
+#include <span>
+
+#include "arbitration.h"
+#include "chopstick_locks.h"
+#include "duration_distribution.h"
+#include "fast_random.h"
+#include "resource_topology.h"
+#include "wait_stats.h"
 
 class PhilosopherManager;
+class CoroScheduler;
+class CoroTask;
+class WorkStealingPool;
+template <typename T> class TimerWheel;
+
+// 执行模式
+enum class ExecutionMode {
+    THREADED,   // 每个哲学家一个内核线程（默认）
+    COROUTINE,  // 所有哲学家是协程，由一个调度线程驱动
+    POOLED      // 哲学家是状态机任务，由工作窃取线程池驱动
+};
+
+// 模拟参数
+struct SimulationOptions {
+    ExecutionMode mode = ExecutionMode::THREADED;  // 执行模式
+    bool pin_threads = false;  // 按 CPU 拓扑绑定哲学家线程，相邻座位共享核 / NUMA 节点
+    double time_scale = 1.0;   // 思考/进餐时长缩放系数，压测时可调小（由管理器统一作用到下面两个分布上）
+    DurationDistribution think_duration = DurationDistribution::uniform(1000, 5000);  // 思考时长
+    DurationDistribution eat_duration = DurationDistribution::uniform(1000, 3000);    // 进餐时长
+    int pool_workers = 0;      // 线程池模式的工作线程数，0 表示使用硬件线程数
+    std::shared_ptr<const ResourceTopology> topology;  // 资源冲突图，为空时使用环形桌
+    int scheduler_cpu = -1;    // 协程模式调度线程绑定的 CPU，-1 时按 pin_threads 决定
+    // 每次进餐完成后回调，在执行该哲学家的线程上调用（协程模式下即调度线程）
+    std::function<void(int seat)> on_meal;
+    std::uint64_t seed = 0;    // 随机种子，0 表示由 random_device 生成；每个座位再按编号派生
+    ArbitrationPolicy arbitration = ArbitrationPolicy::SEMAPHORE;  // 服务员名额的分配策略（线程模式）
+    std::vector<double> seat_weights;  // 仲裁用的权重/优先级，按座位编号循环取用，空表示都为 1
+    int waiter_capacity = 0;   // 同时拿筷子的名额，0 表示 n-1；调小后仲裁策略的差别才明显
+    // 线程模式下筷子锁的实现。票号锁和 MCS 排上队后不能放弃：不支持饥饿超时，
+    // tryAcquireChopsticks 只要带截止时间或取消令牌就报错返回空，只能用 acquireChopsticks 阻塞获取
+    ChopstickLockKind chopstick_lock = ChopstickLockKind::TIMED_MUTEX;
+    // 在位图里标记变化过的座位供渲染端增量更新；关闭时状态切换不写任何共享数据（压测默认关闭）
+    bool track_changes = false;
+    // 统计筷子在 NUMA 节点之间的交接；每次拿筷子都要查询所在 CPU 并写每根筷子的计数，只在测量时打开
+    bool track_traffic = false;
+};
+
+// 筷子交接统计：跨 NUMA 节点的交接意味着缓存行要穿过互联总线
+struct ChopstickTrafficStats {
+    long long acquisitions = 0;  // 有记录的交接次数
+    long long cross_node = 0;    // 前后两任持有者位于不同节点的次数
+};
+
+// 取消令牌：等待筷子期间会被周期性检查，置位后等待立即放弃
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_release); }
+    void reset() { cancelled_.store(false, std::memory_order_release); }
+    bool isCancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
 
 // 哲学家状态枚举
 enum class PhilosopherState {
@@ -23,7 +89,8 @@ enum class PhilosopherState {
 // 哲学家类
 class Philosopher {
 public:
-    Philosopher(int id, int num_philosophers, PhilosopherManager& manager);
+    Philosopher(int id, int num_philosophers, PhilosopherManager& manager,
+                const SimulationOptions& options = SimulationOptions());
     ~Philosopher();
     
     // 禁止拷贝和移动
@@ -33,15 +100,27 @@ public:
     Philosopher& operator=(Philosopher&&) = delete;
     
     void start();  // 启动哲学家线程
-    void stop();   // 停止哲学家线程
+    void stop();   // 停止哲学家线程（requestStop + join）
+    void requestStop();  // 只发出停止信号并唤醒睡眠，不等待线程结束
+    void join();         // 等待线程结束
     PhilosopherState getState() const;  // 获取当前状态
     int getEatCount() const;           // 获取进餐次数
     int getId() const;                 // 获取哲学家ID
+    std::chrono::nanoseconds getHungryTime() const;  // 累计饥饿时长，含正在进行的一次
     void eat();                        // 进餐方法
+    void setHungryTimeout(std::chrono::milliseconds timeout);  // 饥饿超时，0 表示一直等待
+    void setCpu(int cpu);              // 线程启动后绑定的 CPU，-1 表示不绑定
+    void setVacant(bool vacant);       // 空座只思考不进餐，不再参与争用；可在运行中切换
+    bool isVacant() const;
+    CoroTask runCoroutine(CoroScheduler& scheduler);  // run() 的协程版本，不占用内核线程
+    void beginPooled(WorkStealingPool& pool);    // 线程池模式：进入第一次思考
+    void runPooledStep(WorkStealingPool& pool);  // 线程池模式：推进一个状态阶段
 
 private:
     void run();    // 线程主函数
     void think();  // 思考方法
+    void setState(PhilosopherState state);  // 更新状态并通知管理器（渲染端据此增量更新）
+    bool sleepFor(std::chrono::milliseconds duration);  // 可被 requestStop 打断的睡眠，被打断返回 false
 
     int id_;                          // 哲学家ID
     int num_philosophers_;            // 哲学家总数
@@ -50,18 +129,27 @@ private:
     std::atomic<PhilosopherState> state_;  // 原子状态变量
     std::atomic<bool> running_;       // 运行标志
     std::atomic<int> eat_count_;      // 进餐次数计数
+    std::atomic<bool> vacant_;        // 座位空着：思考结束后继续思考
+    CancellationToken cancel_token_;  // stop() 时取消正在进行的等待
+    std::mutex sleep_mutex_;          // 保护睡眠等待
+    std::condition_variable sleep_cv_;  // requestStop 通过它唤醒思考/进餐中的线程
+    std::chrono::milliseconds hungry_timeout_;  // 超时后放弃本轮进餐
+    int cpu_;                         // 绑定的 CPU
+    std::atomic<std::int64_t> hungry_since_ns_;  // 本次开始饥饿的时刻（steady_clock 纳秒），0 表示不在饥饿
+    std::atomic<std::int64_t> hungry_total_ns_;  // 已结束的饥饿时长之和
     
-    // 随机数生成器
-    std::random_device rd_;
-    std::mt19937 gen_;
-    std::uniform_int_distribution<int> think_dist_;  // 思考时间分布
-    std::uniform_int_distribution<int> eat_dist_;    // 进餐时间分布
+    // 随机数生成器（8 字节状态，10 万座位时不再为每人背一个 5 KB 的 mt19937）
+    Pcg32 gen_;
+    DurationDistribution think_dist_;  // 思考时间分布（与其他哲学家共享分位点表）
+    DurationDistribution eat_dist_;    // 进餐时间分布
+    DurationDistribution::Cursor think_cursor_;  // 回放记录时各自的读取位置
+    DurationDistribution::Cursor eat_cursor_;
 };
 
 // 哲学家管理器类
 class PhilosopherManager {
 public:
-    PhilosopherManager(int num_philosophers = 5);
+    PhilosopherManager(int num_philosophers = 5, const SimulationOptions& options = SimulationOptions());
     ~PhilosopherManager();
     
     // 禁止拷贝和移动
@@ -75,50 +163,92 @@ public:
     PhilosopherState getPhilosopherState(int id) const;  // 获取哲学家状态
     int getPhilosopherEatCount(int id) const;           // 获取进餐次数
     int getNumPhilosophers() const;                     // 获取哲学家数量
+    int getNumChopsticks() const;                       // 获取筷子（资源）数量
     int getChopstickOwner(int idx) const;               // 获取某根筷子的持有者
+    std::span<const int> chopsticksFor(int id) const;   // 哲学家需要的全部筷子，按编号升序
+    const ResourceTopology& getTopology() const;        // 获取资源冲突图
+
+    void setHungryTimeout(std::chrono::milliseconds timeout);  // 设置所有哲学家的饥饿超时，排队锁下报错并忽略
+    bool canAbandonWait() const;  // 筷子锁能否超时或被取消，见 SimulationOptions::chopstick_lock
+    void notifyMealFinished(int id);  // 由哲学家在进餐完成后调用，转发给 on_meal
+    void setSeatVacant(int id, bool vacant);  // 空出或重新坐满某个座位，下一轮思考结束后生效
+    bool isSeatVacant(int id) const;
+    void markChanged(int id);         // 座位状态或其持有的筷子变化后调用，先写数据再调用
+    // 把自上次调用以来变化过的座位编号追加到 out 并清除标记；只在 track_changes 打开时有内容。
+    // 构造后第一次调用返回全部座位。只应由一个读者调用
+    void takeChangedSeats(std::vector<int>& out);
+    ChopstickTrafficStats getTrafficStats() const;       // 汇总筷子交接统计，track_traffic 关闭时恒为 0
+    const WaitRecorder& getWaitStats() const;            // 饥饿等待统计（线程模式）
+    std::chrono::nanoseconds getHungryTime(int id) const;  // 某座位的累计饥饿时长（所有执行模式）
+    void placeChopstick(int id);  // 由绑核的哲学家线程启动时调用，在本节点分配以它为首个使用者的筷子
 
     struct ChopstickGuard;
     ChopstickGuard acquireChopsticks(int id);
+    // 带截止时间和取消令牌的获取，超时或被取消时返回空；要求 canAbandonWait()
+    std::optional<ChopstickGuard> tryAcquireChopsticks(int id,
+                                                       std::chrono::steady_clock::time_point deadline,
+                                                       const CancellationToken* token = nullptr);
 
 private:
     std::vector<std::unique_ptr<Philosopher>> philosophers_;  // 使用智能指针
-    std::vector<std::unique_ptr<std::mutex>> chopsticks_;     // 使用智能指针
+    std::unique_ptr<ChopstickLocks> chopsticks_;              // 线程模式的筷子锁
+    std::shared_ptr<const ResourceTopology> topology_;        // 谁需要哪些筷子
     sem_t waiter_;                                            // 服务员信号量
     int num_philosophers_;                                    // 哲学家数量
+    std::unique_ptr<AdmissionArbiter> arbiter_;               // 非空时代替信号量分配服务员名额
+    WaitRecorder wait_stats_;                                 // 从饥饿到拿齐筷子的等待时间
     std::vector<std::atomic<int>> chopstick_owner_;           // 记录筷子持有者
+    // 变化座位位图：每个字管 64 个座位、各占一条缓存行；读者整字取走，只看非零的字，
+    // 不必逐个座位比较。写者在位已置上时只读不写，读者跟不上时不会反复争抢缓存行
+    struct alignas(64) ChangedWord {
+        std::atomic<std::uint64_t> bits{0};
+    };
+    std::vector<ChangedWord> changed_seats_;                  // 不跟踪时为空
+    SimulationOptions options_;                               // 模拟参数
+    std::unique_ptr<TimerWheel<std::coroutine_handle<>>> coroutine_timers_;  // 协程模式的时间轮
+    std::unique_ptr<CoroScheduler> scheduler_;                // 协程模式的调度器
+    std::thread scheduler_thread_;                            // 协程模式的驱动线程
+    std::unique_ptr<WorkStealingPool> pool_;                  // 线程池模式的调度器
 
-    void releaseChopsticksInternal(int owner, int left, int right);
+    // 每根筷子的交接统计，只在持有该筷子时写入；各占一条缓存行，相邻筷子的计数不会伪共享
+    struct alignas(64) ChopstickTraffic {
+        std::atomic<int> last_node{-1};
+        std::atomic<long long> acquisitions{0};
+        std::atomic<long long> cross_node{0};
+    };
+    std::vector<ChopstickTraffic> chopstick_traffic_;  // 不统计时为空
+
+    // 绑核模式下的启动屏障：所有筷子在各自节点分配完毕后才开始进餐
+    std::mutex placement_mutex_;
+    std::condition_variable placement_cv_;
+    int placement_pending_;
+
+    void recordAcquisition(std::span<const int> chopsticks);
+    // chopsticks 中第 i 根在冲突图邻接数组里的下标，作为排队锁的等待者槽位
+    std::size_t slotOf(std::span<const int> chopsticks, std::size_t i) const;
+
+    bool waitForWaiter(int id, std::chrono::steady_clock::time_point deadline,
+                       const CancellationToken* token);  // 分片等待服务员名额
+    void leaveWaiter(int id);                            // 归还服务员名额
+    void releaseChopsticksInternal(int owner, std::span<const int> chopsticks);
 };
 
+// 持有一组已加锁的筷子，析构时按相同集合解锁并归还服务员名额
 struct PhilosopherManager::ChopstickGuard {
-    std::unique_lock<std::mutex> left_lock;
-    std::unique_lock<std::mutex> right_lock;
     PhilosopherManager* manager;
     int owner;
-    int left_idx;
-    int right_idx;
-
-    ChopstickGuard(std::unique_lock<std::mutex>&& left,
-                   std::unique_lock<std::mutex>&& right,
-                   PhilosopherManager* mgr,
-                   int owner_id,
-                   int left_index,
-                   int right_index)
-        : left_lock(std::move(left)),
-          right_lock(std::move(right)),
-          manager(mgr),
+    std::span<const int> chopsticks;  // 指向冲突图中的邻接数组，无需额外分配
+
+    ChopstickGuard(PhilosopherManager* mgr, int owner_id, std::span<const int> held)
+        : manager(mgr),
           owner(owner_id),
-          left_idx(left_index),
-          right_idx(right_index)
+          chopsticks(held)
     {}
 
     ChopstickGuard(ChopstickGuard&& other) noexcept
-        : left_lock(std::move(other.left_lock)),
-          right_lock(std::move(other.right_lock)),
-          manager(other.manager),
+        : manager(other.manager),
           owner(other.owner),
-          left_idx(other.left_idx),
-          right_idx(other.right_idx)
+          chopsticks(other.chopsticks)
     {
         other.manager = nullptr;
     }
@@ -127,12 +257,9 @@ struct PhilosopherManager::ChopstickGuard {
     {
         if (this != &other) {
             release();
-            left_lock = std::move(other.left_lock);
-            right_lock = std::move(other.right_lock);
             manager = other.manager;
             owner = other.owner;
-            left_idx = other.left_idx;
-            right_idx = other.right_idx;
+            chopsticks = other.chopsticks;
             other.manager = nullptr;
         }
         return *this;
@@ -143,7 +270,7 @@ struct PhilosopherManager::ChopstickGuard {
     void release()
     {
         if (manager) {
-            manager->releaseChopsticksInternal(owner, left_idx, right_idx);
+            manager->releaseChopsticksInternal(owner, chopsticks);
             manager = nullptr;
         }
     }
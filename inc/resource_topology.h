@@ -0,0 +1,45 @@
+#ifndef RESOURCE_TOPOLOGY_H
+#define RESOURCE_TOPOLOGY_H
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 资源冲突图：每条边是一根“筷子”，边的两个端点是共用它的两个哲学家。
+// 环形桌是最简单的情形；网格、随机正则图或外部边表可以描述更一般的争用关系。
+// 邻接关系用 CSR 存储，每个座位的资源按编号升序排列，按序加锁即可避免死锁。
+class ResourceTopology {
+public:
+    static ResourceTopology ring(int seats);                       // 资源 i 连接座位 i 与 i+1
+    static ResourceTopology torus(int rows, int cols);             // 每个座位与上下左右四邻各共用一根，2 行（列）时上下（左右）是同一邻居，只共用一根
+    // 每个座位恰好 degree 根筷子的简单图；参数不可行或多次随机配对都失败时返回空
+    static std::optional<ResourceTopology> randomRegular(int seats, int degree, std::uint64_t seed);
+    static ResourceTopology fromEdges(int seats, const std::vector<std::pair<int, int>>& edges,
+                                      std::string name = "edges");
+    // 每行 "u v" 一条边，# 开头为注释；读取失败返回空
+    static std::optional<ResourceTopology> fromEdgeList(const std::string& path);
+    // 解析 ring:N / torus:RxC / regular:N:K[:seed] / file:path
+    static std::optional<ResourceTopology> parse(const std::string& spec, int default_seats);
+
+    int numSeats() const { return static_cast<int>(seat_offsets_.size()) - 1; }
+    int numResources() const { return static_cast<int>(resource_offsets_.size()) - 1; }
+    std::span<const int> resourcesOf(int seat) const;  // 升序
+    std::span<const int> usersOf(int resource) const;
+    int maxDegree() const { return max_degree_; }
+    const std::string& name() const { return name_; }
+
+private:
+    ResourceTopology() = default;
+
+    std::string name_;
+    std::vector<int> seat_offsets_;      // CSR：座位 -> 资源
+    std::vector<int> seat_resources_;
+    std::vector<int> resource_offsets_;  // CSR：资源 -> 座位
+    std::vector<int> resource_users_;
+    int max_degree_ = 0;
+};
+
+#endif // RESOURCE_TOPOLOGY_H
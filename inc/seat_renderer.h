@@ -0,0 +1,66 @@
+#ifndef SEAT_RENDERER_H
+#define SEAT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "philosopher.h"
+
+// 细节层次：按座位在屏幕上的像素尺寸选择
+enum class SeatLod {
+    FULL,    // 头像 + 状态图标
+    POINTS,  // 每座位一个按状态着色的点精灵
+    RING     // 整桌一个圆环，逐片元按角度查座位状态着色
+};
+
+// 实例化绘制哲学家头像和状态图标。
+// 座位坐标构造时上传一次，之后每个座位只有 1 字节状态；
+// setState 只改写变化的座位，draw 时把脏区间合并成一次上传。
+// 圆环层次假定座位按编号等角度排在以原点为圆心的圆上（与主程序的布局一致）。
+class SeatRenderer {
+public:
+    // icons 依次为思考、饥饿、进餐图标，与 PhilosopherState 的取值对应
+    SeatRenderer(const std::string& vertex_path, const std::string& fragment_path,
+                 std::span<const glm::vec2> seats, float seat_radius, glm::vec2 icon_half_size,
+                 float icon_offset, GLuint portrait, const std::array<GLuint, 3>& icons);
+    ~SeatRenderer();
+
+    SeatRenderer(const SeatRenderer&) = delete;
+    SeatRenderer& operator=(const SeatRenderer&) = delete;
+
+    void setState(int seat, PhilosopherState state);
+    // pixels_per_unit：归一化坐标的一个单位对应的像素数，用来选择细节层次
+    void draw(const glm::mat4& projection, float pixels_per_unit);
+
+    SeatLod lodFor(float pixels_per_unit) const;
+
+    int count() const { return static_cast<int>(states_.size()); }
+
+private:
+    GLuint program_ = 0;
+    GLint projection_location_ = -1;
+    GLint pass_location_ = -1;
+    GLuint vao_ = 0;
+    GLuint quad_vbo_ = 0;
+    GLuint seat_vbo_ = 0;
+    GLuint state_vbo_ = 0;
+    GLuint state_texture_ = 0;  // 与 state_vbo_ 共用存储的缓冲纹理，圆环层次按编号取状态
+
+    GLuint portrait_;
+    std::array<GLuint, 3> icons_;
+    float seat_radius_;
+    float ring_radius_;   // 座位所在圆的半径
+    float seat_spacing_;  // 相邻座位的圆心距
+
+    std::vector<std::uint8_t> states_;  // GPU 状态缓冲的 CPU 镜像
+    int dirty_begin_ = 0;               // 待上传的区间 [dirty_begin_, dirty_end_)
+    int dirty_end_ = 0;
+};
+
+#endif // SEAT_RENDERER_H
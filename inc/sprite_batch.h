@@ -0,0 +1,76 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 一个待绘制的四边形；circle 为真时按内切圆裁剪，等价于原来的圆形扇面
+struct Sprite {
+    glm::vec2 center;
+    glm::vec2 half_size;
+    float rotation = 0.0f;          // 弧度，逆时针
+    GLuint texture = 0;             // 0 表示纯色
+    glm::vec4 color = glm::vec4(1.0f);
+    bool circle = false;
+    int layer = 0;                  // 先画小层号；同层内按纹理归并，不保证提交顺序
+};
+
+// 每帧把所有精灵写进一个环形顶点缓冲，按（层，纹理）合并成尽量少的绘制调用。
+// 支持 ARB_buffer_storage 时缓冲持久映射，三帧轮转并用 fence 防止覆盖 GPU 仍在读的区域；
+// 否则每帧孤立（orphan）整块缓冲再上传。两种路径下 CPU 侧都只是一次线性拷贝。
+class SpriteBatch {
+public:
+    SpriteBatch(const std::string& vertex_path, const std::string& fragment_path,
+                std::size_t initial_sprites = 1024);
+    ~SpriteBatch();
+
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    void begin();
+    void add(const Sprite& sprite);
+    void flush(const glm::mat4& projection);
+
+    bool persistent() const { return persistent_; }
+    int lastDrawCalls() const { return last_draw_calls_; }
+    std::size_t lastSprites() const { return last_sprites_; }
+
+private:
+    static constexpr int kRegions = 3;  // 环形缓冲分区数，即允许同时在途的帧数
+
+    struct Vertex {
+        float x, y;
+        float u, v;
+        std::uint8_t r, g, b, a;
+        float circle;
+    };
+
+    void allocate(std::size_t sprites);  // 按精灵容量（重新）创建顶点与索引缓冲
+    void release();
+    void waitRegion(int region);
+
+    GLuint program_ = 0;
+    GLint projection_location_ = -1;
+    GLuint vao_ = 0;
+    GLuint vbo_ = 0;
+    GLuint ebo_ = 0;
+    GLuint white_texture_ = 0;
+
+    bool persistent_ = false;
+    Vertex* mapped_ = nullptr;           // 持久映射的起始地址
+    std::size_t capacity_ = 0;           // 每个分区可容纳的精灵数
+    int region_ = 0;
+    GLsync fences_[kRegions] = {};
+
+    std::vector<Sprite> sprites_;
+    std::vector<Vertex> staging_;
+    int last_draw_calls_ = 0;
+    std::size_t last_sprites_ = 0;
+};
+
+#endif // SPRITE_BATCH_H
@@ -0,0 +1,94 @@
+#ifndef TABLE_SHARDS_H
+#define TABLE_SHARDS_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "fast_random.h"
+#include "philosopher.h"
+
+// 多桌分片参数
+struct ShardOptions {
+    int shards = 4;                      // 桌子数量，每张桌子一个协程调度线程
+    int seats_per_shard = 5;             // simulation.topology 为空时每桌的环形座位数
+    // 每张桌子的模拟参数：资源冲突图、思考/进餐分布、时间缩放等；执行模式固定为协程，
+    // 调度线程绑核和进餐回调由分片组自己设置，随机种子按桌号派生
+    SimulationOptions simulation;
+    bool pin_shards = false;             // 每个分片的调度线程绑定到独立 CPU
+    double migration_probability = 0.0;  // 每次进餐后换桌的概率
+    int lobby_size = 2;                  // 每张桌子初始的候座客人数
+    std::uint64_t seed = 1;
+};
+
+struct ShardStats {
+    long long meals = 0;
+    long long migrations_out = 0;
+    long long migrations_in = 0;
+    int lobby = 0;   // 当前候座人数
+    int seated = 0;  // 当前有人的座位数，即本桌的争用者数量
+};
+
+// 多张互不共享状态的桌子：每张桌子是一个协程模式的 PhilosopherManager，
+// 由自己的调度线程驱动，热路径上只访问本分片的数据。
+// 换桌是消息传递：离桌的客人被投递到目标桌的邮箱，目标桌在自己的线程上取出，
+// 有空座就坐下参与争用，否则进候座队列。离开的座位由本桌候座队首补上，没人候座就空着，
+// 空座不再抢筷子，所以负载真正随客人在桌子之间移动，客人总数守恒。
+// 邮箱只在进餐回调里收取，因此每张桌子至少留一位客人；stop() 之后收下仍在途中的客人。
+class TableShardGroup {
+public:
+    explicit TableShardGroup(const ShardOptions& options);
+    ~TableShardGroup();
+
+    TableShardGroup(const TableShardGroup&) = delete;
+    TableShardGroup& operator=(const TableShardGroup&) = delete;
+
+    void start();
+    void stop();
+
+    int getNumShards() const;
+    PhilosopherManager& getShard(int index);
+    ShardStats getShardStats(int index) const;
+    int getGuestAt(int shard, int seat) const;  // 座位上客人的全局编号，空座为 -1（仅在停止后读取）
+
+private:
+    struct Guest {
+        int id;
+        long long meals;
+    };
+
+    // 每个分片独占缓存行，统计计数器之间不会伪共享
+    struct alignas(64) Shard {
+        std::unique_ptr<PhilosopherManager> manager;
+
+        // 以下只由本分片调度线程访问
+        std::vector<Guest> seat_guest;  // 空座的 id 为 -1
+        std::vector<int> vacant;        // 空座编号
+        std::deque<Guest> lobby;
+        Pcg32 rng;
+
+        // 邮箱：其他分片投递，本分片在进餐回调里取走
+        std::mutex mailbox_mutex;
+        std::vector<Guest> mailbox;
+        std::atomic<bool> has_mail{false};
+
+        std::atomic<long long> meals{0};
+        std::atomic<long long> migrations_out{0};
+        std::atomic<long long> migrations_in{0};
+        std::atomic<int> lobby_size{0};
+        std::atomic<int> seated{0};
+    };
+
+    void onMeal(int shard, int seat);
+    void drainMailbox(Shard& shard);
+    void seatGuest(Shard& shard, int seat, const Guest& guest);
+    void post(int target, const Guest& guest);
+
+    ShardOptions options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // TABLE_SHARDS_H
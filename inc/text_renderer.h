@@ -0,0 +1,50 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 点阵字体文字渲染：全部字形放在一张图集纹理里，一帧内所有文字和底板
+// 累积成一个顶点数组，flush 时一次绘制。坐标以像素为单位，原点在左上角。
+// 字体只含可打印 ASCII，其他字符画成空格。
+class TextRenderer {
+public:
+    TextRenderer(const std::string& vertex_path, const std::string& fragment_path);
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    void begin();
+    // 从 (x, y) 开始写一行或多行（'\n' 换行），返回最宽一行的像素宽度
+    float addText(float x, float y, std::string_view text, glm::vec4 color, float scale = 1.0f);
+    void addRect(float x, float y, float width, float height, glm::vec4 color);  // 纯色底板
+    void flush(int framebuffer_width, int framebuffer_height);
+
+    static float glyphWidth(float scale = 1.0f);
+    static float lineHeight(float scale = 1.0f);
+
+private:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        std::uint8_t r, g, b, a;
+    };
+
+    void addQuad(float x, float y, float width, float height, int cell, glm::vec4 color);
+
+    GLuint program_ = 0;
+    GLint viewport_location_ = -1;
+    GLuint vao_ = 0;
+    GLuint vbo_ = 0;
+    GLuint atlas_ = 0;
+    std::size_t capacity_ = 0;  // 顶点缓冲能容纳的顶点数
+    std::vector<Vertex> vertices_;
+};
+
+#endif // TEXT_RENDERER_H
@@ -0,0 +1,176 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 哈希分层时间轮：插入和到期都是 O(1)，与定时器总数无关。
+// 第 0 层 256 个槽，每槽一个 tick；其余三层各 64 个槽，每层槽宽是下一层整圈；
+// tick 为 1 毫秒时可覆盖约 18 小时，更远的定时器会在最高层反复降级直到到期。
+// 非线程安全，由持有它的调度线程独占使用。
+template <typename T>
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(Clock::time_point origin = Clock::now(),
+                        std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+        : origin_(origin), tick_(tick), current_(0), size_(0), occupied_{}
+    {
+    }
+
+    // 登记一个到期时间，已经过期的会在下一次 advance 时触发
+    void schedule(Clock::time_point deadline, T payload)
+    {
+        std::uint64_t expire = std::max(tickOf(deadline), current_ + 1);
+        insert(Entry{expire, std::move(payload)});
+        ++size_;
+    }
+
+    // 推进到 now，按到期顺序对每个到期的定时器调用 fire(payload)
+    template <typename Fire>
+    void advance(Clock::time_point now, Fire&& fire)
+    {
+        std::uint64_t target = tickOf(now);
+        while (size_ > 0 && current_ < target) {
+            std::uint64_t next = nextOccupiedTick();
+            if (next > target) {
+                current_ = target;  // 中间没有非空槽，也不会跨过整圈边界
+                break;
+            }
+            current_ = next;
+            if ((current_ & kLevel0Mask) == 0)
+                cascadeAll();
+            fireSlot(current_ & kLevel0Mask, fire);
+        }
+        if (size_ == 0 && current_ < target)
+            current_ = target;  // 空轮直接跳到当前时刻
+    }
+
+    // 下一次需要醒来的时间：本圈内最近的非空槽，或下一次降级的整圈边界
+    Clock::time_point nextExpiry() const
+    {
+        if (size_ == 0)
+            return Clock::time_point::max();
+        return timeOf(nextOccupiedTick());
+    }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void clear()
+    {
+        for (auto& slot : level0_)
+            slot.clear();
+        for (auto& level : upper_)
+            for (auto& slot : level)
+                slot.clear();
+        occupied_ = {};
+        size_ = 0;
+    }
+
+private:
+    static constexpr int kLevel0Bits = 8;
+    static constexpr int kUpperBits = 6;
+    static constexpr int kUpperLevels = 3;
+    static constexpr std::uint64_t kLevel0Size = 1ull << kLevel0Bits;
+    static constexpr std::uint64_t kLevel0Mask = kLevel0Size - 1;
+    static constexpr std::uint64_t kUpperSize = 1ull << kUpperBits;
+    static constexpr std::uint64_t kUpperMask = kUpperSize - 1;
+
+    struct Entry {
+        std::uint64_t expire;
+        T payload;
+    };
+    using Slot = std::vector<Entry>;
+
+    static constexpr int shiftOf(int level) { return kLevel0Bits + kUpperBits * level; }
+
+    std::uint64_t tickOf(Clock::time_point time) const
+    {
+        if (time <= origin_)
+            return 0;
+        if (time == Clock::time_point::max())
+            return ~0ull >> 1;
+        return static_cast<std::uint64_t>((time - origin_) / tick_);
+    }
+
+    Clock::time_point timeOf(std::uint64_t tick) const { return origin_ + tick_ * tick; }
+
+    void insert(Entry entry)
+    {
+        std::uint64_t delta = entry.expire - current_;
+        if (delta < kLevel0Size) {
+            std::uint64_t index = entry.expire & kLevel0Mask;
+            level0_[index].push_back(std::move(entry));
+            occupied_[index >> 6] |= 1ull << (index & 63);
+            return;
+        }
+        for (int level = 0; level < kUpperLevels; ++level) {
+            if (delta < (1ull << shiftOf(level + 1)) || level == kUpperLevels - 1) {
+                std::uint64_t slotTick = entry.expire;
+                if (delta >= (1ull << shiftOf(level + 1))) {
+                    // 超出最高层范围：放到最后才会被访问的槽，降级时重新计算位置
+                    slotTick = current_ - (1ull << shiftOf(level));
+                }
+                upper_[level][(slotTick >> shiftOf(level)) & kUpperMask].push_back(std::move(entry));
+                return;
+            }
+        }
+    }
+
+    // 当前 tick 恰好是某层整圈边界时，从高到低把对应槽位的定时器降到下层
+    void cascadeAll()
+    {
+        for (int level = kUpperLevels - 1; level >= 0; --level) {
+            std::uint64_t boundary = 1ull << shiftOf(level);
+            if ((current_ & (boundary - 1)) != 0)
+                continue;
+            Slot moved;
+            moved.swap(upper_[level][(current_ >> shiftOf(level)) & kUpperMask]);
+            for (Entry& entry : moved)
+                insert(std::move(entry));
+        }
+    }
+
+    template <typename Fire>
+    void fireSlot(std::uint64_t index, Fire& fire)
+    {
+        Slot due;
+        due.swap(level0_[index]);
+        occupied_[index >> 6] &= ~(1ull << (index & 63));
+        size_ -= due.size();
+        for (Entry& entry : due)
+            fire(std::move(entry.payload));
+    }
+
+    // 本圈内 current_ 之后第一个非空槽对应的 tick；本圈没有则返回下一个整圈边界
+    std::uint64_t nextOccupiedTick() const
+    {
+        std::uint64_t roundStart = current_ & ~kLevel0Mask;
+        std::uint64_t from = (current_ & kLevel0Mask) + 1;
+        for (std::uint64_t index = from; index < kLevel0Size;) {
+            std::uint64_t bits = occupied_[index >> 6] >> (index & 63);
+            if (bits != 0)
+                return roundStart + index + std::countr_zero(bits);
+            index = (index | 63) + 1;
+        }
+        return roundStart + kLevel0Size;
+    }
+
+    Clock::time_point origin_;
+    std::chrono::milliseconds tick_;
+    std::uint64_t current_;  // 已处理到的 tick
+    std::size_t size_;
+    std::array<Slot, kLevel0Size> level0_;
+    std::array<std::array<Slot, kUpperSize>, kUpperLevels> upper_;
+    std::array<std::uint64_t, kLevel0Size / 64> occupied_;  // 第 0 层非空槽位图
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,44 @@
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 只读映射的时长记录文件：每个数值是一次持有时长（毫秒，可带小数），
+// 以空白或换行分隔，# 开头的行为注释。带负号、指数等其他字符的记录在游标读到时才校验：
+// 报告其字节偏移（每个文件只报一次）并跳过，不会把 -5 读成 5。
+// 文件按需缺页、顺序读取，不整体解析进内存；多个读者各自持有游标，互不干扰。
+class MappedTrace {
+public:
+    static std::shared_ptr<const MappedTrace> open(const std::string& path);
+
+    ~MappedTrace();
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    // 从游标处读取下一个时长（微秒）并前移游标，读到文件尾时从头回绕
+    std::uint32_t next(std::size_t& cursor) const;
+
+    // 把文件大致均分给各座位，起点对齐到行首，使不同座位回放不同片段
+    std::size_t startCursor(int seat, int seats) const;
+
+    std::size_t sizeBytes() const { return size_; }
+    const std::string& path() const { return path_; }
+
+private:
+    MappedTrace(std::string path, const char* data, std::size_t size);
+
+    enum class Record { VALUE, INVALID, END };
+    // 读取游标处的一条记录并把游标移到它之后；INVALID 时 invalid 为第一个不合法字节的偏移
+    Record parseAt(std::size_t& cursor, std::uint32_t& micros, std::size_t& invalid) const;
+
+    std::string path_;
+    const char* data_;
+    std::size_t size_;
+    mutable std::atomic<bool> reported_{false};  // 不合法记录已经报告过
+};
+
+#endif // TRACE_FILE_H
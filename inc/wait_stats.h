@@ -0,0 +1,54 @@
+#ifndef WAIT_STATS_H
+#define WAIT_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// 饥饿等待的汇总（毫秒）
+struct WaitSummary {
+    std::uint64_t samples = 0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// 记录“开始饥饿到拿齐筷子”的等待时间。
+// 每个座位的计数只由该座位的线程写入；全局直方图按 2 的幂分组、每组再分 8 档，
+// 分位数误差不超过 12.5%，写入只是一次无锁加法。
+class WaitRecorder {
+public:
+    explicit WaitRecorder(int seats);
+
+    void record(int seat, std::chrono::nanoseconds wait);
+
+    std::uint64_t count(int seat) const;
+    double meanMs(int seat) const;
+    WaitSummary summary() const;
+
+private:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = 40 * kSubBuckets;  // 覆盖 1 微秒到约 12 天
+
+    static int bucketOf(std::uint64_t micros);
+    static double bucketUpperMs(int bucket);
+
+    struct Seat {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> total_ns{0};
+    };
+    std::unique_ptr<Seat[]> seats_;
+    int num_seats_;
+    std::array<std::atomic<std::uint64_t>, kBuckets> histogram_{};
+    std::atomic<std::uint64_t> max_ns_{0};
+};
+
+// Jain 公平指数：(Σx)² / (n·Σx²)，全部相等时为 1，只有一个非零时为 1/n
+double jainIndex(std::span<const double> values);
+
+#endif // WAIT_STATS_H
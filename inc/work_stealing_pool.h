@@ -0,0 +1,82 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "timer_wheel.h"
+
+// 线程池执行模式的调度器：每个工作线程有自己的双端队列，
+// 本线程从队尾取（最近放下筷子唤醒的座位，缓存最热），空闲线程从别人队头偷
+class WorkStealingPool {
+public:
+    using Clock = std::chrono::steady_clock;
+    using StepFunction = std::function<void(int seat)>;
+
+    // chopstick_owner 即管理器的筷子持有表；step 推进某个座位的一个状态阶段。
+    // 资源图上筷子数与座位数不一定相等，挂起标记按座位数分配
+    WorkStealingPool(int num_workers, int num_seats, std::vector<std::atomic<int>>& chopstick_owner,
+                     StepFunction step);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void start(const std::vector<int>& worker_cpus);  // worker_cpus 为空表示不绑核
+    void stop();
+
+    // 以下接口由 step 回调在工作线程上调用（start 之前也可在主线程调用）
+    void scheduleAfter(int seat, std::chrono::milliseconds delay);  // 延时后再次执行该座位
+    // chopsticks 须按编号升序；全部拿到返回 true，否则挂起等待唤醒
+    bool tryAcquireOrPark(int seat, std::span<const int> chopsticks);
+    void releaseChopsticks(std::span<const int> chopsticks);  // 放下筷子，挂起的邻居进入本线程队列
+
+    int getNumWorkers() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;  // 保护 ready 与 timers
+        std::deque<int> ready;
+        TimerWheel<int> timers;  // 本线程调度的思考/进餐到期，只由本线程推进
+        std::thread thread;
+    };
+
+    struct ChopstickSlot {
+        std::mutex mutex;          // 只保护检查与挂起这一小段，不会在进餐期间持有
+        std::vector<int> waiters;  // 挂起在这根筷子上的座位
+    };
+
+    void lockSlots(std::span<const int> chopsticks);
+    void unlockSlots(std::span<const int> chopsticks);
+    void workerLoop(int index);
+    void pushReady(int worker, int seat);
+    bool popLocal(Worker& worker, int& seat);
+    bool steal(int thief, int& seat);
+    Clock::time_point fireExpiredTimers(Worker& worker);  // 返回下一个定时器的到期时间
+    int currentWorker();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::atomic<int>>& chopstick_owner_;
+    std::vector<ChopstickSlot> slots_;
+    std::vector<std::atomic<bool>> parked_;  // 座位是否挂起，防止被两根筷子重复唤醒
+    StepFunction step_;
+    std::atomic<int> next_worker_;  // 主线程调度时轮流分配
+
+    // 空闲等待：push 时递增 epoch_，有人睡眠才加锁通知，避免丢失唤醒
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<std::uint64_t> epoch_;
+    std::atomic<int> sleepers_;
+    std::atomic<bool> stop_;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;   // 单位四边形角点 [-1,1]
+layout (location = 1) in vec2 aRest;     // 无人持有时的位置
+layout (location = 2) in vec2 aFrom;     // 持有者变化时刻的位置
+layout (location = 3) in float aStart;   // 持有者变化时刻（秒）
+layout (location = 4) in int aOwner;     // -1 表示无人持有
+
+uniform mat4 projection;
+uniform samplerBuffer seatPositions;
+uniform vec2 halfSize;
+uniform float time;
+uniform float easeRate;
+
+void main()
+{
+    vec2 target = aRest;
+    if(aOwner >= 0)
+        target = aRest + (texelFetch(seatPositions, aOwner).xy - aRest) * 0.5;
+
+    // 与 ChopstickRenderer::positionAt 相同的指数缓动
+    float remain = exp(-easeRate * max(time - aStart, 0.0));
+    vec2 center = target + (aFrom - target) * remain;
+
+    // 长边指向桌子中心
+    vec2 axisY = length(center) > 0.0 ? normalize(-center) : vec2(0.0, 1.0);
+    vec2 axisX = vec2(axisY.y, -axisY.x);
+    vec2 pos = center + axisX * (aCorner.x * halfSize.x) + axisY * (aCorner.y * halfSize.y);
+    gl_Position = projection * vec4(pos, 0.0, 1.0);
+}
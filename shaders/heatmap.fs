@@ -0,0 +1,28 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D heatSampler;
+uniform float columns;
+
+// 黑 → 蓝 → 黄 → 红
+vec3 palette(float t)
+{
+    vec3 c0 = vec3(0.05, 0.05, 0.10);
+    vec3 c1 = vec3(0.15, 0.30, 0.90);
+    vec3 c2 = vec3(0.95, 0.85, 0.20);
+    vec3 c3 = vec3(0.90, 0.15, 0.10);
+    if(t < 1.0 / 3.0)
+        return mix(c0, c1, t * 3.0);
+    if(t < 2.0 / 3.0)
+        return mix(c1, c2, t * 3.0 - 1.0);
+    return mix(c2, c3, t * 3.0 - 2.0);
+}
+
+void main()
+{
+    // 横向取列中心，避免线性过滤把最新和最旧的列在接缝处混在一起；纵向仍线性平均相邻行
+    vec2 uv = vec2((floor(TexCoord.x * columns) + 0.5) / columns, TexCoord.y);
+    FragColor = vec4(palette(texture(heatSampler, uv).r), 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;  // [0,1] 单位矩形
+
+out vec2 TexCoord;
+
+uniform mat4 projection;
+uniform vec4 rect;     // 左下角 xy，右上角 zw
+uniform float head;    // 下一次写入的列，即最旧的一列
+uniform float columns;
+
+void main()
+{
+    vec2 pos = mix(rect.xy, rect.zw, aCorner);
+    gl_Position = projection * vec4(pos, 0.0, 1.0);
+    // 从最旧一列开始向右铺满，纹理横向重复；座位 0 画在上方
+    TexCoord = vec2(aCorner.x + head / columns, 1.0 - aCorner.y);
+}
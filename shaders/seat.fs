@@ -0,0 +1,69 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec2 Local;
+flat in int State;
+
+uniform int pass;
+uniform sampler2D portraitSampler;
+uniform sampler2D thinkingSampler;
+uniform sampler2D hungrySampler;
+uniform sampler2D eatingSampler;
+uniform usamplerBuffer stateBuffer;
+uniform float ringRadius;
+uniform float ringWidth;
+uniform int seatCount;
+
+// 点与圆环层次的状态配色：思考、饥饿、进餐
+const vec3 stateColors[3] = vec3[3](vec3(0.35, 0.55, 0.95), vec3(0.95, 0.35, 0.25), vec3(0.35, 0.85, 0.40));
+
+void main()
+{
+    vec4 color;
+    if(pass == 0)
+    {
+        // 头像按内切圆裁剪
+        vec2 d = TexCoord * 2.0 - 1.0;
+        if(dot(d, d) > 1.0)
+            discard;
+        color = texture(portraitSampler, TexCoord);
+    }
+    else if(pass == 1)
+    {
+        // 三张图标都采样再选择，避免在非一致控制流里采样带 mipmap 的纹理
+        vec4 thinking = texture(thinkingSampler, TexCoord);
+        vec4 hungry = texture(hungrySampler, TexCoord);
+        vec4 eating = texture(eatingSampler, TexCoord);
+        color = State == 0 ? thinking : (State == 1 ? hungry : eating);
+    }
+    else if(pass == 2)
+    {
+        vec2 d = gl_PointCoord * 2.0 - 1.0;
+        if(dot(d, d) > 1.0)
+            discard;
+        color = vec4(stateColors[State], 1.0);
+    }
+    else
+    {
+        float r = length(Local);
+        if(abs(r - ringRadius) > ringWidth)
+            discard;
+        // 座位 i 位于角度 2πi/n；一个片元覆盖多个座位时取其中至多 8 个的平均色
+        float position = fract(atan(Local.y, Local.x) / 6.28318530718) * float(seatCount);
+        float span = clamp(fwidth(position), 1.0, 8.0);
+        int samples = int(ceil(span));
+        vec3 sum = vec3(0.0);
+        for(int i = 0; i < samples; ++i)
+        {
+            int seat = int(floor(position - 0.5 * span + (float(i) + 0.5) * span / float(samples) + 0.5));
+            seat = (seat % seatCount + seatCount) % seatCount;
+            sum += stateColors[texelFetch(stateBuffer, seat).r];
+        }
+        color = vec4(sum / float(samples), 1.0);
+    }
+    if(color.a < 0.1)
+        discard;
+
+    FragColor = color;
+}
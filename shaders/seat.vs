@@ -0,0 +1,45 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;  // 单位四边形角点 [-1,1]
+layout (location = 1) in vec2 aSeat;    // 座位中心
+layout (location = 2) in int aState;    // PhilosopherState 的取值
+
+out vec2 TexCoord;
+out vec2 Local;         // 圆环层次：片元相对桌心的位置
+flat out int State;
+
+uniform mat4 projection;
+uniform int pass;           // 0 头像，1 状态图标，2 点，3 圆环
+uniform float seatRadius;
+uniform vec2 iconHalfSize;
+uniform float iconOffset;
+uniform float pointSize;
+uniform float ringRadius;
+uniform float ringWidth;
+
+void main()
+{
+    vec2 pos;
+    if(pass == 0)
+    {
+        pos = aSeat + aCorner * seatRadius;
+    }
+    else if(pass == 1)
+    {
+        // 图标放在座位外侧
+        vec2 direction = length(aSeat) > 0.0 ? normalize(aSeat) : vec2(0.0, 1.0);
+        pos = aSeat + direction * iconOffset + aCorner * iconHalfSize;
+    }
+    else if(pass == 2)
+    {
+        pos = aSeat;
+        gl_PointSize = pointSize;
+    }
+    else
+    {
+        pos = aCorner * (ringRadius + ringWidth);
+    }
+    gl_Position = projection * vec4(pos, 0.0, 1.0);
+    TexCoord = aCorner * 0.5 + 0.5;
+    Local = pos;
+    State = aState;
+}
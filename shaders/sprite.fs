@@ -0,0 +1,25 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+in float Circle;
+
+uniform sampler2D texSampler;
+
+void main()
+{
+    // 圆形精灵：纹理坐标映射到 [-1,1]，裁掉内切圆以外的部分
+    if(Circle > 0.5)
+    {
+        vec2 d = TexCoord * 2.0 - 1.0;
+        if(dot(d, d) > 1.0)
+            discard;
+    }
+
+    vec4 color = texture(texSampler, TexCoord) * Color;
+    if(color.a < 0.1)
+        discard;
+
+    FragColor = color;
+}
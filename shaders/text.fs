@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+uniform sampler2D atlasSampler;
+
+void main()
+{
+    float coverage = texture(atlasSampler, TexCoord).r;
+    if(coverage < 0.5)
+        discard;
+    FragColor = Color;
+}
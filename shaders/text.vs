@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;       // 像素坐标，原点在左上角
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+uniform vec2 viewport;  // 帧缓冲像素尺寸
+
+void main()
+{
+    vec2 ndc = vec2(aPos.x / viewport.x * 2.0 - 1.0, 1.0 - aPos.y / viewport.y * 2.0);
+    gl_Position = vec4(ndc, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
@@ -0,0 +1,200 @@
+#include "arbitration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kDrrQuantumMs = 1.0;  // 每轮按权重补充的额度
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+}  // namespace
+
+std::optional<ArbitrationPolicy> parseArbitrationPolicy(const std::string& name)
+{
+    if (name == "semaphore")
+        return ArbitrationPolicy::SEMAPHORE;
+    if (name == "fifo")
+        return ArbitrationPolicy::FIFO;
+    if (name == "priority")
+        return ArbitrationPolicy::PRIORITY;
+    if (name == "wfq")
+        return ArbitrationPolicy::WFQ;
+    if (name == "drr")
+        return ArbitrationPolicy::DRR;
+    if (name == "lottery")
+        return ArbitrationPolicy::LOTTERY;
+    return std::nullopt;
+}
+
+const char* arbitrationPolicyName(ArbitrationPolicy policy)
+{
+    switch (policy) {
+    case ArbitrationPolicy::SEMAPHORE: return "semaphore";
+    case ArbitrationPolicy::FIFO:      return "fifo";
+    case ArbitrationPolicy::PRIORITY:  return "priority";
+    case ArbitrationPolicy::WFQ:       return "wfq";
+    case ArbitrationPolicy::DRR:       return "drr";
+    case ArbitrationPolicy::LOTTERY:   return "lottery";
+    }
+    return "unknown";
+}
+
+AdmissionArbiter::AdmissionArbiter(ArbitrationPolicy policy, int seats, int capacity,
+                                   const std::vector<double>& weights, std::uint64_t seed)
+    : policy_(policy),
+      capacity_(std::max(1, capacity)),
+      slots_(std::make_unique<Slot[]>(seats)),
+      lottery_rng_(seed)
+{
+    for (int seat = 0; seat < seats; ++seat) {
+        double weight = weights.empty() ? 1.0 : weights[seat % weights.size()];
+        slots_[seat].weight = weight > 0.0 ? weight : 1.0;
+    }
+    waiting_.reserve(seats);
+}
+
+void AdmissionArbiter::enqueue(int seat)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[seat];
+    slot.state = SlotState::WAITING;
+    slot.arrival = next_arrival_++;
+    slot.start_tag = std::max(virtual_time_, slot.finish_tag);
+    slot.deficit = std::min(slot.deficit, 0.0);  // 空闲期间不积攒额度，只保留欠账
+    waiting_.push_back(seat);
+    dispatch();
+}
+
+void AdmissionArbiter::wait(int seat)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot& slot = slots_[seat];
+    slot.cv.wait(lock, [&slot]() { return slot.state == SlotState::ADMITTED; });
+}
+
+bool AdmissionArbiter::waitUntil(int seat, std::chrono::steady_clock::time_point until)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot& slot = slots_[seat];
+    return slot.cv.wait_until(lock, until, [&slot]() { return slot.state == SlotState::ADMITTED; });
+}
+
+bool AdmissionArbiter::withdraw(int seat)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[seat];
+    if (slot.state == SlotState::ADMITTED)
+        return false;
+    auto it = std::find(waiting_.begin(), waiting_.end(), seat);
+    if (it != waiting_.end())
+        removeWaiting(static_cast<std::size_t>(it - waiting_.begin()));
+    slot.state = SlotState::IDLE;
+    return true;
+}
+
+void AdmissionArbiter::release(int seat)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[seat];
+    double heldMs = elapsedMs(slot.admitted_at);
+    slot.finish_tag = slot.start_tag + heldMs / slot.weight;
+    slot.deficit -= heldMs;
+    slot.state = SlotState::IDLE;
+    --in_use_;
+    dispatch();
+}
+
+void AdmissionArbiter::removeWaiting(std::size_t index)
+{
+    waiting_.erase(waiting_.begin() + static_cast<std::ptrdiff_t>(index));
+    if (index < drr_cursor_)
+        --drr_cursor_;
+}
+
+void AdmissionArbiter::dispatch()
+{
+    while (in_use_ < capacity_ && !waiting_.empty()) {
+        int seat = pickNext();
+        Slot& slot = slots_[seat];
+        slot.state = SlotState::ADMITTED;
+        slot.admitted_at = std::chrono::steady_clock::now();
+        if (policy_ == ArbitrationPolicy::WFQ)
+            virtual_time_ = std::max(virtual_time_, slot.start_tag);
+        ++in_use_;
+        slot.cv.notify_one();
+    }
+}
+
+int AdmissionArbiter::pickNext()
+{
+    std::size_t chosen = 0;
+
+    switch (policy_) {
+    case ArbitrationPolicy::SEMAPHORE:
+    case ArbitrationPolicy::FIFO:
+        break;  // 队首即最早到达者
+
+    case ArbitrationPolicy::PRIORITY:
+        for (std::size_t i = 1; i < waiting_.size(); ++i) {
+            if (slots_[waiting_[i]].weight > slots_[waiting_[chosen]].weight)
+                chosen = i;  // 同权重时保留先到达的
+        }
+        break;
+
+    case ArbitrationPolicy::WFQ:
+        for (std::size_t i = 1; i < waiting_.size(); ++i) {
+            if (slots_[waiting_[i]].start_tag < slots_[waiting_[chosen]].start_tag)
+                chosen = i;
+        }
+        break;
+
+    case ArbitrationPolicy::DRR:
+        while (true) {
+            std::size_t n = waiting_.size();
+            if (drr_cursor_ >= n)
+                drr_cursor_ = 0;
+            for (std::size_t step = 0; step < n; ++step) {
+                std::size_t index = (drr_cursor_ + step) % n;
+                if (slots_[waiting_[index]].deficit > 0.0) {
+                    int seat = waiting_[index];
+                    removeWaiting(index);
+                    drr_cursor_ = index;  // 下一位从它后面的座位开始
+                    return seat;
+                }
+            }
+            // 一圈下来没有人有额度：直接补足到至少一人转正所需的轮数，省去空转
+            double rounds = std::numeric_limits<double>::max();
+            for (int seat : waiting_) {
+                const Slot& slot = slots_[seat];
+                rounds = std::min(rounds, std::floor(-slot.deficit / (kDrrQuantumMs * slot.weight)) + 1.0);
+            }
+            for (int seat : waiting_) {
+                slots_[seat].deficit += rounds * kDrrQuantumMs * slots_[seat].weight;
+            }
+        }
+
+    case ArbitrationPolicy::LOTTERY: {
+        double total = 0.0;
+        for (int seat : waiting_) {
+            total += slots_[seat].weight;
+        }
+        double ticket = lottery_rng_.uniform01() * total;
+        for (chosen = 0; chosen + 1 < waiting_.size(); ++chosen) {
+            ticket -= slots_[waiting_[chosen]].weight;
+            if (ticket < 0.0)
+                break;
+        }
+        break;
+    }
+    }
+
+    int seat = waiting_[chosen];
+    removeWaiting(chosen);
+    return seat;
+}
@@ -0,0 +1,410 @@
+// 无窗口压测工具：在不同配置下运行哲学家模拟并输出吞吐与交接统计
+#include "parallel_des.h"
+#include "philosopher.h"
+#include "table_shards.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct BenchConfig {
+    int seats = 5;
+    double seconds = 5.0;
+    SimulationOptions options;
+    bool virtual_time = false;  // 使用并行离散事件模拟而不是实时运行
+    DesOptions des;
+    bool check_partitions = false;  // 另跑一遍单分段模拟，要求每个座位的进餐次数完全相同
+    std::string topology = "ring";  // 见 ResourceTopology::parse
+    bool sharded = false;           // 多桌分片模式
+    ShardOptions shard;
+    bool sampling = false;          // 只测时长采样的开销
+    bool lock_bench = false;        // 只测筷子锁本身：多线程反复抢 seats 把锁
+    int threads = 8;
+};
+
+void printUsage(const char* argv0)
+{
+    std::cerr << "用法: " << argv0 << " [--seats N] [--seconds S] [--time-scale X] [--pin] [--traffic]"
+              << " [--mode threaded|coroutine|pooled|des|shards|sampling|locks] [--workers N]"
+              << " [--partitions P] [--virtual-seconds S] [--check-partitions]"
+              << " [--topology ring[:N]|torus:RxC|regular:N:K[:seed]|file:path]"
+              << " [--shards K] [--migration P] [--lobby L]"
+              << " [--arbitration semaphore|fifo|priority|wfq|drr|lottery]"
+              << " [--locks mutex|ticket|mcs] [--threads T] [--weights w0,w1,...] [--waiters N]"
+              << " [--think DIST] [--eat DIST]  (DIST: uniform:MIN:MAX|exp:MEAN[:MIN]|lognormal:MEDIAN:SIGMA|file:path|hist:path|trace:path)"
+              << std::endl;
+    std::cerr << "  des: 保守式并行虚拟时间模拟，P 段的结果与单段逐座位相同"
+              << "（--check-partitions 另跑单段核对）；最短时长为 0 时只能单段运行" << std::endl;
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seats" && hasValue) {
+            config.seats = std::atoi(argv[++i]);
+        } else if (arg == "--seconds" && hasValue) {
+            config.seconds = std::atof(argv[++i]);
+        } else if (arg == "--time-scale" && hasValue) {
+            config.options.time_scale = std::atof(argv[++i]);
+        } else if (arg == "--mode" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "threaded") {
+                config.options.mode = ExecutionMode::THREADED;
+            } else if (mode == "coroutine") {
+                config.options.mode = ExecutionMode::COROUTINE;
+            } else if (mode == "pooled") {
+                config.options.mode = ExecutionMode::POOLED;
+            } else if (mode == "des") {
+                config.virtual_time = true;
+            } else if (mode == "shards") {
+                config.sharded = true;
+            } else if (mode == "sampling") {
+                config.sampling = true;
+            } else if (mode == "locks") {
+                config.lock_bench = true;
+            } else {
+                return false;
+            }
+        } else if (arg == "--workers" && hasValue) {
+            config.options.pool_workers = std::atoi(argv[++i]);
+        } else if (arg == "--partitions" && hasValue) {
+            config.des.partitions = std::atoi(argv[++i]);
+        } else if (arg == "--check-partitions") {
+            config.check_partitions = true;
+        } else if (arg == "--virtual-seconds" && hasValue) {
+            config.des.virtual_seconds = std::atof(argv[++i]);
+        } else if (arg == "--topology" && hasValue) {
+            config.topology = argv[++i];
+        } else if (arg == "--shards" && hasValue) {
+            config.shard.shards = std::atoi(argv[++i]);
+        } else if (arg == "--migration" && hasValue) {
+            config.shard.migration_probability = std::atof(argv[++i]);
+        } else if (arg == "--lobby" && hasValue) {
+            config.shard.lobby_size = std::atoi(argv[++i]);
+        } else if ((arg == "--think" || arg == "--eat") && hasValue) {
+            auto distribution = DurationDistribution::parse(argv[++i]);
+            if (!distribution)
+                return false;
+            (arg == "--think" ? config.options.think_duration : config.options.eat_duration) = *distribution;
+            (arg == "--think" ? config.des.think : config.des.eat) = *distribution;
+        } else if (arg == "--arbitration" && hasValue) {
+            auto policy = parseArbitrationPolicy(argv[++i]);
+            if (!policy)
+                return false;
+            config.options.arbitration = *policy;
+        } else if (arg == "--weights" && hasValue) {
+            std::istringstream fields(argv[++i]);
+            std::string weight;
+            while (std::getline(fields, weight, ',')) {
+                config.options.seat_weights.push_back(std::atof(weight.c_str()));
+            }
+        } else if (arg == "--locks" && hasValue) {
+            auto kind = parseChopstickLockKind(argv[++i]);
+            if (!kind)
+                return false;
+            config.options.chopstick_lock = *kind;
+        } else if (arg == "--threads" && hasValue) {
+            config.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--waiters" && hasValue) {
+            config.options.waiter_capacity = std::atoi(argv[++i]);
+        } else if (arg == "--pin") {
+            config.options.pin_threads = true;
+        } else if (arg == "--traffic") {
+            config.options.track_traffic = true;
+        } else {
+            return false;
+        }
+    }
+    if (config.sharded && config.shard.migration_probability > 0.0 && config.shard.lobby_size <= 0) {
+        std::cerr << "--migration needs a lobby: --lobby must be at least 1" << std::endl;
+        return false;
+    }
+    return config.seats >= 2 && config.seconds > 0.0 && config.options.time_scale > 0.0;
+}
+
+int runVirtualTime(const BenchConfig& config)
+{
+    DesOptions options = config.des;
+    options.topology = config.options.topology;
+    options.num_seats = options.topology->numSeats();
+    ParallelDesSimulation simulation(options);
+    DesResult result = simulation.run();
+
+    std::cout << "topology=" << options.topology->name()
+              << " seats=" << options.num_seats
+              << " partitions=" << result.partitions
+              << " virtual_s=" << options.virtual_seconds
+              << " meals=" << result.meals
+              << " events=" << result.events
+              << " events/s=" << result.events / result.wall_seconds
+              << " windows=" << result.windows
+              << " exposed_events=" << result.exposed_events
+              << " stalls=" << result.stalls
+              << " seat_bytes=" << result.seat_bytes
+              << " wall_s=" << result.wall_seconds << std::endl;
+
+    if (!config.check_partitions || result.partitions <= 1)
+        return 0;
+    // 保守式并行模拟必须与单分段的顺序模拟逐座位一致
+    DesOptions reference = options;
+    reference.partitions = 1;
+    DesResult sequential = ParallelDesSimulation(reference).run();
+    bool identical = result.eat_counts == sequential.eat_counts && result.events == sequential.events;
+    std::cout << "reference_meals=" << sequential.meals << " reference_events=" << sequential.events
+              << " identical=" << (identical ? "yes" : "no") << std::endl;
+    if (!identical) {
+        std::cerr << "Partitioned run differs from the single-partition run" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 对比三种采样路径每次的开销：标准库、PCG32 + 查表、xoshiro128++ 批量生成 + 批量查表
+int runSampling(const BenchConfig& config)
+{
+    constexpr std::size_t kSamples = 1 << 25;
+    constexpr std::size_t kBatch = 4096;
+    const DurationDistribution& distribution = config.options.think_duration;
+    if (distribution.isTrace()) {
+        std::cerr << "Sampling bench needs a sampled distribution, not a trace" << std::endl;
+        return 1;
+    }
+    auto elapsedNs = [](auto begin) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    };
+
+    std::uint64_t sink = 0;
+    std::mt19937 mt(1);
+    std::uniform_int_distribution<int> standard(1000, 5000);
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        sink += standard(mt);
+    }
+    double standardNs = elapsedNs(begin) / kSamples;
+
+    Pcg32 pcg(1);
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        sink += distribution.sampleMicros(pcg());
+    }
+    double pcgNs = elapsedNs(begin) / kSamples;
+
+    Xoshiro128pp xoshiro(1);
+    std::vector<std::uint32_t> randoms(kBatch);
+    std::vector<std::uint32_t> durations(kBatch);
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t done = 0; done < kSamples; done += kBatch) {
+        xoshiro.fill(randoms);
+        distribution.sampleMicros(randoms, durations);
+        for (std::uint32_t duration : durations) {
+            sink += duration;  // 与前两种路径一样每个样本都计入，编译器不能省掉任何一次查表
+        }
+    }
+    double batchNs = elapsedNs(begin) / kSamples;
+
+    std::cout << "distribution=" << distribution.describe()
+              << " mt19937_ns=" << standardNs
+              << " pcg32_ns=" << pcgNs
+              << " xoshiro_batch_ns=" << batchNs
+              << " checksum=" << sink << std::endl;
+    return 0;
+}
+
+// 锁微基准：threads 个线程随机抢 seats 把锁，临界区只改一个计数器。
+// 锁越少争用越重；队列锁的放锁只写后继节点，等待者增多时吞吐下降应更平缓
+int runLockBench(const BenchConfig& config)
+{
+    struct alignas(64) Counter {
+        std::uint64_t value = 0;
+    };
+
+    int locks = config.seats;
+    ChopstickLocks chopsticks(config.options.chopstick_lock, locks, static_cast<std::size_t>(config.threads));
+    std::vector<Counter> counters(locks);
+    std::vector<Counter> perThread(config.threads);
+    std::atomic<bool> running{true};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&, t]() {
+            Pcg32 rng(mixSeed(static_cast<std::uint64_t>(t)));
+            std::uint64_t done = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                int lock = static_cast<int>(rng.bounded(static_cast<std::uint32_t>(locks)));
+                chopsticks.lock(lock, static_cast<std::size_t>(t));
+                ++counters[lock].value;
+                chopsticks.unlock(lock, static_cast<std::size_t>(t));
+                ++done;
+            }
+            perThread[t].value = done;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+    running.store(false, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::uint64_t total = 0;
+    std::vector<double> shares;
+    for (const Counter& counter : perThread) {
+        total += counter.value;
+        shares.push_back(static_cast<double>(counter.value));
+    }
+    std::uint64_t counted = 0;
+    for (const Counter& counter : counters) {
+        counted += counter.value;
+    }
+
+    std::cout << "locks=" << chopstickLockKindName(config.options.chopstick_lock)
+              << " threads=" << config.threads
+              << " lock_count=" << locks
+              << " ops/s=" << total / config.seconds
+              << " jain=" << jainIndex(shares)
+              << " consistent=" << (counted == total ? "yes" : "no") << std::endl;
+    return counted == total ? 0 : 1;
+}
+
+int runSharded(const BenchConfig& config)
+{
+    ShardOptions options = config.shard;
+    options.seats_per_shard = config.seats;
+    options.simulation = config.options;  // 每桌使用同一张冲突图和同样的时长分布
+    options.pin_shards = config.options.pin_threads;
+
+    TableShardGroup group(options);
+    auto begin = std::chrono::steady_clock::now();
+    group.start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+    group.stop();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    ShardStats total;
+    int fewestSeated = config.seats;
+    int mostSeated = 0;
+    for (int i = 0; i < group.getNumShards(); ++i) {
+        ShardStats stats = group.getShardStats(i);
+        total.meals += stats.meals;
+        total.migrations_out += stats.migrations_out;
+        total.migrations_in += stats.migrations_in;
+        fewestSeated = std::min(fewestSeated, stats.seated);
+        mostSeated = std::max(mostSeated, stats.seated);
+    }
+
+    std::cout << "shards=" << options.shards
+              << " seats/shard=" << options.seats_per_shard
+              << " pin=" << (options.pin_shards ? "on" : "off")
+              << " meals=" << total.meals
+              << " meals/s=" << total.meals / elapsed
+              << " migrations_out=" << total.migrations_out
+              << " migrations_in=" << total.migrations_in
+              << " seated_min=" << fewestSeated
+              << " seated_max=" << mostSeated << std::endl;
+    // 客人守恒：停止后邮箱已收空，每张桌子至少还有一位客人
+    if (total.migrations_in != total.migrations_out || fewestSeated == 0) {
+        std::cerr << "Shard migration lost guests or emptied a table" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    config.options.time_scale = 0.01;  // 默认把 1~5 秒缩短到 10~50 毫秒
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    auto topology = ResourceTopology::parse(config.topology, config.seats);
+    if (!topology) {
+        return 1;
+    }
+    config.options.topology = std::make_shared<const ResourceTopology>(std::move(*topology));
+    config.seats = config.options.topology->numSeats();
+
+    if (config.virtual_time) {
+        return runVirtualTime(config);
+    }
+    if (config.sharded) {
+        return runSharded(config);
+    }
+    if (config.sampling) {
+        return runSampling(config);
+    }
+    if (config.lock_bench) {
+        return runLockBench(config);
+    }
+
+    PhilosopherManager manager(config.seats, config.options);
+    auto begin = std::chrono::steady_clock::now();
+    manager.start();
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+    manager.stop();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    long long meals = 0;
+    std::vector<double> shares(config.seats);  // 按权重归一化的进餐次数，用于公平指数
+    std::map<double, std::pair<double, double>> tiers;  // 权重 -> (进餐次数, 平均等待) 的累加
+    std::map<double, int> tierSeats;
+    const WaitRecorder& waits = manager.getWaitStats();
+    for (int i = 0; i < config.seats; ++i) {
+        int eaten = manager.getPhilosopherEatCount(i);
+        meals += eaten;
+        const auto& weights = config.options.seat_weights;
+        double weight = weights.empty() ? 1.0 : weights[i % weights.size()];
+        shares[i] = eaten / (weight > 0.0 ? weight : 1.0);
+        tiers[weight].first += eaten;
+        tiers[weight].second += waits.meanMs(i);
+        ++tierSeats[weight];
+    }
+    WaitSummary wait = waits.summary();
+
+    ChopstickTrafficStats traffic = manager.getTrafficStats();
+    double crossRatio = traffic.acquisitions > 0
+                            ? static_cast<double>(traffic.cross_node) / traffic.acquisitions
+                            : 0.0;
+
+    std::cout << "topology=" << config.options.topology->name()
+              << " seats=" << config.seats
+              << " pin=" << (config.options.pin_threads ? "on" : "off")
+              << " meals=" << meals
+              << " meals/s=" << meals / elapsed;
+    if (config.options.track_traffic) {
+        std::cout << " handoffs=" << traffic.acquisitions
+                  << " cross_node=" << traffic.cross_node
+                  << " cross_ratio=" << crossRatio;
+    }
+    if (config.options.mode == ExecutionMode::THREADED) {
+        std::cout << " arbitration=" << arbitrationPolicyName(config.options.arbitration)
+                  << " locks=" << chopstickLockKindName(config.options.chopstick_lock)
+                  << " jain=" << jainIndex(shares)
+                  << " wait_mean_ms=" << wait.mean_ms
+                  << " wait_p99_ms=" << wait.p99_ms
+                  << " wait_max_ms=" << wait.max_ms;
+        if (tiers.size() > 1) {
+            // 每个权重档位的平均进餐次数和平均等待
+            std::cout << " tiers=";
+            for (const auto& [weight, sums] : tiers) {
+                int seats = tierSeats[weight];
+                std::cout << weight << ":" << sums.first / seats << "meals/" << sums.second / seats << "ms ";
+            }
+        }
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "chopstick_locks.h"
+
+#include <thread>
+
+namespace {
+
+constexpr int kSpinBeforePark = 128;  // 先自旋这么多次，交接通常在此之内完成
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+}  // namespace
+
+void McsLock::lock(McsNode& node)
+{
+    node.next.store(nullptr, std::memory_order_relaxed);
+    node.locked.store(true, std::memory_order_relaxed);
+    McsNode* previous = tail_.exchange(&node, std::memory_order_acq_rel);
+    if (!previous)
+        return;
+
+    previous->next.store(&node, std::memory_order_release);
+    for (int spin = 0; spin < kSpinBeforePark && node.locked.load(std::memory_order_acquire); ++spin) {
+        cpuRelax();
+    }
+    while (node.locked.load(std::memory_order_acquire)) {
+        node.locked.wait(true, std::memory_order_acquire);
+    }
+}
+
+void McsLock::unlock(McsNode& node)
+{
+    McsNode* successor = node.next.load(std::memory_order_acquire);
+    if (!successor) {
+        McsNode* expected = &node;
+        if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+            return;
+        // 后继已经换上尾指针但还没来得及链接，窗口只有几条指令
+        while (!(successor = node.next.load(std::memory_order_acquire))) {
+            std::this_thread::yield();
+        }
+    }
+    successor->locked.store(false, std::memory_order_release);
+    successor->locked.notify_one();
+}
+
+std::optional<ChopstickLockKind> parseChopstickLockKind(const std::string& name)
+{
+    if (name == "mutex")
+        return ChopstickLockKind::TIMED_MUTEX;
+    if (name == "ticket")
+        return ChopstickLockKind::TICKET;
+    if (name == "mcs")
+        return ChopstickLockKind::MCS;
+    return std::nullopt;
+}
+
+const char* chopstickLockKindName(ChopstickLockKind kind)
+{
+    switch (kind) {
+    case ChopstickLockKind::TIMED_MUTEX: return "mutex";
+    case ChopstickLockKind::TICKET:      return "ticket";
+    case ChopstickLockKind::MCS:         return "mcs";
+    }
+    return "unknown";
+}
+
+ChopstickLocks::ChopstickLocks(ChopstickLockKind kind, int count, std::size_t slots)
+    : kind_(kind)
+{
+    switch (kind_) {
+    case ChopstickLockKind::TIMED_MUTEX:
+        mutexes_.resize(count);
+        break;
+    case ChopstickLockKind::TICKET:
+        tickets_.resize(count);
+        break;
+    case ChopstickLockKind::MCS:
+        mcs_.resize(count);
+        nodes_ = std::make_unique<McsNode[]>(slots);
+        break;
+    }
+    for (int i = 0; i < count; ++i) {
+        place(i);
+    }
+}
+
+void ChopstickLocks::lock(int chopstick, std::size_t slot)
+{
+    switch (kind_) {
+    case ChopstickLockKind::TIMED_MUTEX:
+        mutexes_[chopstick]->lock();
+        break;
+    case ChopstickLockKind::TICKET:
+        tickets_[chopstick]->lock();
+        break;
+    case ChopstickLockKind::MCS:
+        mcs_[chopstick]->lock(nodes_[slot]);
+        break;
+    }
+}
+
+bool ChopstickLocks::tryLockUntil(int chopstick, std::chrono::steady_clock::time_point until)
+{
+    return mutexes_[chopstick]->try_lock_until(until);
+}
+
+void ChopstickLocks::unlock(int chopstick, std::size_t slot)
+{
+    switch (kind_) {
+    case ChopstickLockKind::TIMED_MUTEX:
+        mutexes_[chopstick]->unlock();
+        break;
+    case ChopstickLockKind::TICKET:
+        tickets_[chopstick]->unlock();
+        break;
+    case ChopstickLockKind::MCS:
+        mcs_[chopstick]->unlock(nodes_[slot]);
+        break;
+    }
+}
+
+void ChopstickLocks::place(int chopstick)
+{
+    switch (kind_) {
+    case ChopstickLockKind::TIMED_MUTEX:
+        mutexes_[chopstick] = std::make_unique<std::timed_mutex>();
+        break;
+    case ChopstickLockKind::TICKET:
+        tickets_[chopstick] = std::make_unique<TicketLock>();
+        break;
+    case ChopstickLockKind::MCS:
+        mcs_[chopstick] = std::make_unique<McsLock>();
+        break;
+    }
+}
@@ -0,0 +1,153 @@
+#include "chopstick_renderer.h"
+#include "Shader_m.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+// 原先每帧向目标靠近 15%，按 60 帧折算成连续时间的指数衰减：exp(-kEaseRate * t)
+const float kEaseRate = -std::log(0.85f) * 60.0f;
+// 剩余距离不到 0.1% 时视为静止
+const float kSettleSeconds = std::log(1000.0f) / kEaseRate;
+
+}  // namespace
+
+ChopstickRenderer::ChopstickRenderer(const std::string& vertex_path, const std::string& fragment_path,
+                                     std::span<const glm::vec2> seats, std::span<const glm::vec2> rest,
+                                     glm::vec2 half_size, glm::vec4 color)
+    : seats_(seats.begin(), seats.end()),
+      rest_(rest.begin(), rest.end())
+{
+    Shader shader(vertex_path.c_str(), fragment_path.c_str());
+    program_ = shader.ID;
+    projection_location_ = glGetUniformLocation(program_, "projection");
+    time_location_ = glGetUniformLocation(program_, "time");
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "seatPositions"), 0);
+    glUniform2f(glGetUniformLocation(program_, "halfSize"), half_size.x, half_size.y);
+    glUniform4f(glGetUniformLocation(program_, "color"), color.x, color.y, color.z, color.w);
+    glUniform1f(glGetUniformLocation(program_, "easeRate"), kEaseRate);
+
+    // 座位坐标放进缓冲纹理，着色器按持有者编号取用
+    glGenBuffers(1, &seat_buffer_);
+    glBindBuffer(GL_TEXTURE_BUFFER, seat_buffer_);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(seats_.size() * sizeof(glm::vec2)), seats_.data(),
+                 GL_STATIC_DRAW);
+    glGenTextures(1, &seat_texture_);
+    glBindTexture(GL_TEXTURE_BUFFER, seat_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, seat_buffer_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    instances_.resize(rest_.size());
+    for (std::size_t i = 0; i < rest_.size(); ++i) {
+        instances_[i] = Instance{rest_[i].x, rest_[i].y, 0.0f, -1};
+    }
+
+    glGenVertexArrays(1, &vao_);
+    glBindVertexArray(vao_);
+
+    const float corners[8] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glGenBuffers(1, &quad_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &rest_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, rest_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(rest_.size() * sizeof(glm::vec2)), rest_.data(),
+                 GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glGenBuffers(1, &instance_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances_.size() * sizeof(Instance)),
+                 instances_.data(), GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, from_x));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, start));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribIPointer(4, 1, GL_INT, sizeof(Instance), (void*)offsetof(Instance, owner));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
+    glBindVertexArray(0);
+}
+
+ChopstickRenderer::~ChopstickRenderer()
+{
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &quad_vbo_);
+    glDeleteBuffers(1, &rest_vbo_);
+    glDeleteBuffers(1, &instance_vbo_);
+    glDeleteTextures(1, &seat_texture_);
+    glDeleteBuffers(1, &seat_buffer_);
+    glDeleteProgram(program_);
+}
+
+glm::vec2 ChopstickRenderer::target(int chopstick, int owner) const
+{
+    glm::vec2 rest = rest_[chopstick];
+    if (owner < 0)
+        return rest;
+    return rest + (seats_[owner] - rest) * 0.5f;  // 向持有者挪动一半距离
+}
+
+glm::vec2 ChopstickRenderer::positionAt(int chopstick, float now) const
+{
+    const Instance& instance = instances_[chopstick];
+    glm::vec2 to = target(chopstick, instance.owner);
+    glm::vec2 from(instance.from_x, instance.from_y);
+    float remain = std::exp(-kEaseRate * std::max(now - instance.start, 0.0f));
+    return to + (from - to) * remain;
+}
+
+void ChopstickRenderer::setOwner(int chopstick, int owner, float now)
+{
+    Instance& instance = instances_[chopstick];
+    if (instance.owner == owner)
+        return;
+    // 从当前（可能仍在移动的）位置出发，中途换人不会跳变
+    glm::vec2 from = positionAt(chopstick, now);
+    instance = Instance{from.x, from.y, now, owner};
+
+    if (dirty_begin_ == dirty_end_) {
+        dirty_begin_ = chopstick;
+        dirty_end_ = chopstick + 1;
+    } else {
+        dirty_begin_ = std::min(dirty_begin_, chopstick);
+        dirty_end_ = std::max(dirty_end_, chopstick + 1);
+    }
+    settle_time_ = std::max(settle_time_, now + kSettleSeconds);
+}
+
+void ChopstickRenderer::draw(const glm::mat4& projection, float now)
+{
+    glBindVertexArray(vao_);
+    if (dirty_begin_ != dirty_end_) {
+        // 变化通常集中在少数几根，合并成一次区间上传
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo_);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(dirty_begin_ * sizeof(Instance)),
+                        static_cast<GLsizeiptr>((dirty_end_ - dirty_begin_) * sizeof(Instance)),
+                        instances_.data() + dirty_begin_);
+        dirty_begin_ = dirty_end_ = 0;
+    }
+
+    glUseProgram(program_);
+    glUniformMatrix4fv(projection_location_, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1f(time_location_, now);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, seat_texture_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances_.size()));
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray(0);
+}
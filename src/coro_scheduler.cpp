@@ -0,0 +1,131 @@
+#include "coro_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+CoroScheduler::CoroScheduler(std::vector<std::atomic<int>>& chopstick_owner, TimerQueue& timers)
+    : chopstick_owner_(chopstick_owner),
+      waiters_(chopstick_owner.size()),
+      timers_(timers),
+      stop_requested_(false)
+{
+}
+
+CoroScheduler::~CoroScheduler()
+{
+    // 协程帧里的等待者随 tasks_ 一起销毁，先清空引用它们的队列
+    waiters_.clear();
+    ready_.clear();
+    timers_.clear();
+    tasks_.clear();
+}
+
+void CoroScheduler::spawn(CoroTask task)
+{
+    ready_.push_back(task.handle());
+    tasks_.push_back(std::move(task));
+}
+
+CoroScheduler::SleepAwaiter CoroScheduler::sleepFor(std::chrono::milliseconds duration)
+{
+    return SleepAwaiter{*this, Clock::now() + duration};
+}
+
+CoroScheduler::ChopstickAwaiter CoroScheduler::acquireChopsticks(int owner, std::span<const int> chopsticks)
+{
+    return ChopstickAwaiter{*this, owner, chopsticks, nullptr};
+}
+
+void CoroScheduler::releaseChopsticks(std::span<const int> chopsticks)
+{
+    for (int chopstick : chopsticks) {
+        chopstick_owner_[chopstick].store(-1, std::memory_order_release);
+    }
+    for (int chopstick : chopsticks) {
+        wakeWaiters(chopstick);
+    }
+}
+
+void CoroScheduler::run()
+{
+    while (true) {
+        while (!ready_.empty()) {
+            std::coroutine_handle<> handle = ready_.front();
+            ready_.pop_front();
+            handle.resume();
+        }
+
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        if (stop_requested_ || timers_.empty())
+            return;
+
+        // 睡到时间轮下一次需要处理的时刻，期间 requestStop 可以立即打断
+        if (stop_cv_.wait_until(lock, timers_.nextExpiry(), [this] { return stop_requested_; }))
+            return;
+        lock.unlock();
+
+        timers_.advance(Clock::now(), [this](std::coroutine_handle<> handle) {
+            ready_.push_back(handle);
+        });
+    }
+}
+
+void CoroScheduler::requestStop()
+{
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_requested_ = true;
+    }
+    stop_cv_.notify_all();
+}
+
+void CoroScheduler::addTimer(Clock::time_point deadline, std::coroutine_handle<> handle)
+{
+    timers_.schedule(deadline, handle);
+}
+
+bool CoroScheduler::isFree(int chopstick) const
+{
+    return chopstick_owner_[chopstick].load(std::memory_order_relaxed) < 0;
+}
+
+bool CoroScheduler::tryTake(int owner, std::span<const int> chopsticks)
+{
+    for (int chopstick : chopsticks) {
+        if (!isFree(chopstick))
+            return false;
+    }
+    for (int chopstick : chopsticks) {
+        chopstick_owner_[chopstick].store(owner, std::memory_order_release);
+    }
+    return true;
+}
+
+void CoroScheduler::enqueueWaiter(ChopstickAwaiter* waiter)
+{
+    for (int chopstick : waiter->chopsticks) {
+        waiters_[chopstick].push_back(waiter);
+    }
+}
+
+void CoroScheduler::removeWaiter(int chopstick, ChopstickAwaiter* waiter)
+{
+    auto& queue = waiters_[chopstick];
+    queue.erase(std::remove(queue.begin(), queue.end(), waiter), queue.end());
+}
+
+void CoroScheduler::wakeWaiters(int chopstick)
+{
+    // 按排队顺序把筷子交给第一个所需筷子都能拿到的等待者
+    auto& queue = waiters_[chopstick];
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        ChopstickAwaiter* waiter = queue[i];
+        if (tryTake(waiter->owner, waiter->chopsticks)) {
+            for (int held : waiter->chopsticks) {
+                removeWaiter(held, waiter);
+            }
+            ready_.push_back(waiter->handle);
+            return;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tuple>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+int readSysInt(const std::string& path, int fallback)
+{
+    std::ifstream in(path);
+    int value = fallback;
+    if (!(in >> value)) {
+        return fallback;
+    }
+    return value;
+}
+
+// 在 /sys/devices/system/node/nodeN/cpuM 中查找 CPU 所属节点
+int findNumaNode(int cpu)
+{
+    namespace fs = std::filesystem;
+    const fs::path nodeRoot("/sys/devices/system/node");
+    std::error_code ec;
+    if (!fs::is_directory(nodeRoot, ec))
+        return -1;
+
+    for (const auto& entry : fs::directory_iterator(nodeRoot, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4)
+            continue;
+        if (fs::exists(entry.path() / ("cpu" + std::to_string(cpu)), ec)) {
+            return std::atoi(name.c_str() + 4);
+        }
+    }
+    return -1;
+}
+
+// CPU 到节点的映射表，只在第一次使用时构建
+const std::vector<int>& cpuNodeTable()
+{
+    static const std::vector<int> table = [] {
+        std::vector<int> nodes(CPU_SETSIZE, -1);
+        for (const CpuInfo& info : detectCpuTopology()) {
+            if (info.cpu >= 0 && info.cpu < CPU_SETSIZE)
+                nodes[info.cpu] = info.node;
+        }
+        return nodes;
+    }();
+    return table;
+}
+
+}  // namespace
+
+std::vector<CpuInfo> detectCpuTopology()
+{
+    std::vector<CpuInfo> topology;
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return topology;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+
+        std::string topoDir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        CpuInfo info;
+        info.cpu = cpu;
+        info.core = readSysInt(topoDir + "core_id", cpu);
+        info.package = readSysInt(topoDir + "physical_package_id", 0);
+        info.node = findNumaNode(cpu);
+        if (info.node < 0)
+            info.node = info.package;
+        topology.push_back(info);
+    }
+
+    std::sort(topology.begin(), topology.end(), [](const CpuInfo& a, const CpuInfo& b) {
+        return std::tie(a.node, a.package, a.core, a.cpu) < std::tie(b.node, b.package, b.core, b.cpu);
+    });
+    return topology;
+}
+
+std::vector<int> assignSeatCpus(const std::vector<CpuInfo>& topology, int num_seats)
+{
+    std::vector<int> seatCpus(num_seats, -1);
+    if (topology.empty())
+        return seatCpus;
+
+    long long cpus = static_cast<long long>(topology.size());
+    for (int seat = 0; seat < num_seats; ++seat) {
+        long long slot = num_seats <= cpus ? seat : seat * cpus / num_seats;
+        seatCpus[seat] = topology[slot].cpu;
+    }
+    return seatCpus;
+}
+
+bool pinCurrentThread(int cpu)
+{
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int currentNumaNode()
+{
+    int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return -1;
+    return cpuNodeTable()[cpu];
+}
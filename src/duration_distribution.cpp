@@ -0,0 +1,258 @@
+#include "duration_distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+std::uint32_t toMicros(double ms)
+{
+    double us = std::round(ms * 1000.0);
+    return static_cast<std::uint32_t>(std::clamp(us, 0.0, static_cast<double>(std::numeric_limits<std::uint32_t>::max())));
+}
+
+// 标准正态分布的分位数：对 erfc 二分，只在建表时调用
+double normalQuantile(double p)
+{
+    double lo = -10.0;
+    double hi = 10.0;
+    for (int i = 0; i < 100; ++i) {
+        double mid = 0.5 * (lo + hi);
+        if (0.5 * std::erfc(-mid / std::sqrt(2.0)) < p)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+}  // namespace
+
+template <typename Quantile>
+DurationDistribution DurationDistribution::fromQuantile(Kind kind, std::string description, Quantile quantile)
+{
+    auto table = std::make_shared<std::vector<std::uint32_t>>(kTableSize);
+    for (std::size_t i = 0; i < kTableSize; ++i) {
+        double p = (static_cast<double>(i) + 0.5) / static_cast<double>(kTableSize);  // 每个桶取中点
+        (*table)[i] = toMicros(quantile(p));
+    }
+
+    DurationDistribution distribution;
+    distribution.kind_ = kind;
+    distribution.table_ = std::move(table);
+    distribution.description_ = std::move(description);
+    return distribution;
+}
+
+DurationDistribution DurationDistribution::uniform(int min_ms, int max_ms)
+{
+    DurationDistribution distribution;
+    distribution.kind_ = Kind::UNIFORM;
+    distribution.min_us_ = toMicros(std::min(min_ms, max_ms));
+    distribution.span_us_ = static_cast<std::uint64_t>(toMicros(std::max(min_ms, max_ms))) - distribution.min_us_ + 1;
+    distribution.description_ = "uniform:" + std::to_string(min_ms) + ":" + std::to_string(max_ms);
+    return distribution;
+}
+
+DurationDistribution DurationDistribution::exponential(double mean_ms, double min_ms)
+{
+    std::ostringstream description;
+    description << "exp:" << mean_ms << ":" << min_ms;
+    return fromQuantile(Kind::EXPONENTIAL, description.str(), [=](double p) {
+        return min_ms - mean_ms * std::log1p(-p);
+    });
+}
+
+DurationDistribution DurationDistribution::lognormal(double median_ms, double sigma)
+{
+    std::ostringstream description;
+    description << "lognormal:" << median_ms << ":" << sigma;
+    return fromQuantile(Kind::LOGNORMAL, description.str(),
+                        [=](double p) { return median_ms * std::exp(sigma * normalQuantile(p)); });
+}
+
+DurationDistribution DurationDistribution::empirical(std::vector<double> samples_ms)
+{
+    std::sort(samples_ms.begin(), samples_ms.end());
+    std::size_t count = samples_ms.size();
+    return fromQuantile(Kind::EMPIRICAL, "empirical:" + std::to_string(count) + " samples", [&](double p) {
+        return samples_ms[std::min(count - 1, static_cast<std::size_t>(p * static_cast<double>(count)))];
+    });
+}
+
+std::optional<DurationDistribution> DurationDistribution::empirical(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open duration samples: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    std::vector<double> samples;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        double value = 0.0;
+        while (fields >> value) {
+            if (value < 0.0) {
+                std::cerr << "Negative duration in " << path << ": " << line << std::endl;
+                return std::nullopt;
+            }
+            samples.push_back(value);
+        }
+    }
+    if (samples.empty()) {
+        std::cerr << "No duration samples in " << path << std::endl;
+        return std::nullopt;
+    }
+    DurationDistribution distribution = empirical(std::move(samples));
+    distribution.description_ = "file:" + path;
+    return distribution;
+}
+
+std::optional<DurationDistribution> DurationDistribution::histogram(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open histogram: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    std::vector<double> uppers;
+    std::vector<double> cumulative;  // 到该桶为止的累计次数
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        double upper = 0.0;
+        double count = 0.0;
+        if (!(fields >> upper >> count) || count < 0.0 || (!uppers.empty() && upper < uppers.back())) {
+            std::cerr << "Bad histogram bucket in " << path << ": " << line << std::endl;
+            return std::nullopt;
+        }
+        uppers.push_back(upper);
+        cumulative.push_back((cumulative.empty() ? 0.0 : cumulative.back()) + count);
+    }
+    if (cumulative.empty() || cumulative.back() <= 0.0) {
+        std::cerr << "Histogram has no samples: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    double total = cumulative.back();
+    DurationDistribution distribution = fromQuantile(Kind::EMPIRICAL, "hist:" + path, [&](double p) {
+        double target = p * total;
+        std::size_t bucket = std::lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+        bucket = std::min(bucket, cumulative.size() - 1);
+        double lower = bucket == 0 ? 0.0 : uppers[bucket - 1];
+        double before = bucket == 0 ? 0.0 : cumulative[bucket - 1];
+        double inBucket = cumulative[bucket] - before;
+        double fraction = inBucket > 0.0 ? (target - before) / inBucket : 0.0;
+        return lower + (uppers[bucket] - lower) * fraction;
+    });
+    return distribution;
+}
+
+std::optional<DurationDistribution> DurationDistribution::trace(const std::string& path)
+{
+    std::shared_ptr<const MappedTrace> mapped = MappedTrace::open(path);
+    if (!mapped)
+        return std::nullopt;
+
+    DurationDistribution distribution;
+    distribution.kind_ = Kind::TRACE;
+    distribution.trace_ = std::move(mapped);
+    distribution.description_ = "trace:" + path;
+    return distribution;
+}
+
+std::optional<DurationDistribution> DurationDistribution::parse(const std::string& spec)
+{
+    std::string kind = spec.substr(0, spec.find(':'));
+    std::string rest = spec.find(':') == std::string::npos ? "" : spec.substr(spec.find(':') + 1);
+    std::istringstream fields(rest);
+    char sep = 0;
+
+    if (kind == "uniform") {
+        int lo = 0;
+        int hi = 0;
+        if (fields >> lo >> sep >> hi && lo >= 0 && hi >= lo)
+            return uniform(lo, hi);
+    } else if (kind == "exp") {
+        double mean = 0.0;
+        double lo = 0.0;
+        if (fields >> mean && mean > 0.0) {
+            fields >> sep >> lo;
+            return exponential(mean, std::max(0.0, lo));
+        }
+    } else if (kind == "lognormal") {
+        double median = 0.0;
+        double sigma = 0.0;
+        if (fields >> median >> sep >> sigma && median > 0.0 && sigma >= 0.0)
+            return lognormal(median, sigma);
+    } else if (kind == "file") {
+        return empirical(rest);
+    } else if (kind == "hist") {
+        return histogram(rest);
+    } else if (kind == "trace") {
+        return trace(rest);
+    }
+
+    std::cerr << "Bad duration distribution: " << spec << std::endl;
+    return std::nullopt;
+}
+
+DurationDistribution DurationDistribution::scaled(double factor) const
+{
+    DurationDistribution result = *this;
+    if (trace_) {
+        result.trace_scale_ *= factor;  // 回放时再乘，不改动映射的文件
+        return result;
+    }
+    if (!table_) {
+        double maxUs = static_cast<double>(min_us_ + span_us_ - 1) * factor;
+        result.min_us_ = toMicros(min_us_ * factor / 1000.0);
+        result.span_us_ = static_cast<std::uint64_t>(toMicros(maxUs / 1000.0)) - result.min_us_ + 1;
+        return result;
+    }
+
+    auto table = std::make_shared<std::vector<std::uint32_t>>(*table_);
+    for (std::uint32_t& value : *table) {
+        value = toMicros(value * factor / 1000.0);
+    }
+    result.table_ = std::move(table);
+    return result;
+}
+
+void DurationDistribution::sampleMicros(std::span<const std::uint32_t> randoms, std::span<std::uint32_t> out) const
+{
+    std::size_t count = std::min(randoms.size(), out.size());
+    if (!table_) {
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = min_us_ + static_cast<std::uint32_t>((static_cast<std::uint64_t>(randoms[i]) * span_us_) >> 32);
+        }
+        return;
+    }
+    const std::uint32_t* table = table_->data();
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = table[randoms[i] >> (32 - kTableBits)];
+    }
+}
+
+std::uint32_t DurationDistribution::minMicros() const
+{
+    if (trace_)
+        return 0;  // 不扫描整个文件，按最坏情况处理
+    return table_ ? table_->front() : min_us_;
+}
+
+std::string DurationDistribution::describe() const
+{
+    return description_;
+}
@@ -0,0 +1,288 @@
+#include "frame_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+// PNG 只需要 zlib 格式，这里用不压缩的 stored 块：省去压缩耗时，文件大小约等于原始像素
+class PngWriter {
+public:
+    // data 为压缩流的暂存区，跨帧复用
+    PngWriter(std::FILE* file, std::vector<std::uint8_t>& data) : file_(file), data_(data) {}
+
+    bool write(const std::uint8_t* rgba, int width, int height)
+    {
+        static const std::uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        put(signature, sizeof(signature));
+
+        std::uint8_t header[13] = {};
+        putBe32(header, static_cast<std::uint32_t>(width));
+        putBe32(header + 4, static_cast<std::uint32_t>(height));
+        header[8] = 8;  // 每通道 8 位
+        header[9] = 6;  // RGBA
+        chunk("IHDR", header, sizeof(header));
+
+        // 每行前面一个过滤类型字节（0，不过滤），再按 65535 字节切成 stored 块
+        std::size_t stride = static_cast<std::size_t>(width) * 4;
+        std::size_t total = (stride + 1) * height;
+        data_.clear();
+        data_.reserve(2 + total + (total / 65535 + 1) * 5 + 4);
+        data_.push_back(0x78);  // zlib 头：deflate，32K 窗口，无预置字典
+        data_.push_back(0x01);
+        std::uint32_t a = 1, b = 0;  // Adler-32
+        std::size_t row = 0, column = stride + 1;  // column 为当前行已输出字节数，先从新行开始
+        for (std::size_t left = total; left > 0;) {
+            std::size_t block = std::min<std::size_t>(left, 65535);
+            left -= block;
+            data_.push_back(left == 0 ? 1 : 0);
+            data_.push_back(static_cast<std::uint8_t>(block));
+            data_.push_back(static_cast<std::uint8_t>(block >> 8));
+            data_.push_back(static_cast<std::uint8_t>(~block));
+            data_.push_back(static_cast<std::uint8_t>(~block >> 8));
+            while (block > 0) {
+                if (column == stride + 1) {
+                    data_.push_back(0);
+                    b = (b + a) % 65521;
+                    column = 0;
+                    --block;
+                    continue;
+                }
+                std::size_t count = std::min(block, stride - column);
+                const std::uint8_t* source = rgba + row * stride + column;
+                data_.insert(data_.end(), source, source + count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    a += source[i];
+                    b += a;
+                    if ((i & 4095) == 4095) {  // 分批取模，不会溢出
+                        a %= 65521;
+                        b %= 65521;
+                    }
+                }
+                a %= 65521;
+                b %= 65521;
+                column += count;
+                block -= count;
+                if (column == stride) {
+                    ++row;
+                    column = stride + 1;
+                }
+            }
+        }
+        std::uint8_t adler[4];
+        putBe32(adler, (b << 16) | a);
+        data_.insert(data_.end(), adler, adler + 4);
+        chunk("IDAT", data_.data(), data_.size());
+        chunk("IEND", nullptr, 0);
+        return ok_;
+    }
+
+private:
+    static void putBe32(std::uint8_t* out, std::uint32_t value)
+    {
+        out[0] = static_cast<std::uint8_t>(value >> 24);
+        out[1] = static_cast<std::uint8_t>(value >> 16);
+        out[2] = static_cast<std::uint8_t>(value >> 8);
+        out[3] = static_cast<std::uint8_t>(value);
+    }
+
+    static std::uint32_t crc(std::uint32_t crc, const std::uint8_t* data, std::size_t size)
+    {
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> entries{};
+            for (std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+            return entries;
+        }();
+        for (std::size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return crc;
+    }
+
+    void put(const void* data, std::size_t size)
+    {
+        if (size > 0 && std::fwrite(data, 1, size, file_) != size)
+            ok_ = false;
+    }
+
+    void chunk(const char* type, const std::uint8_t* data, std::size_t size)
+    {
+        std::uint8_t length[4];
+        putBe32(length, static_cast<std::uint32_t>(size));
+        put(length, 4);
+        put(type, 4);
+        put(data, size);
+        std::uint32_t sum = crc(0xffffffffu, reinterpret_cast<const std::uint8_t*>(type), 4);
+        sum = crc(sum, data, size) ^ 0xffffffffu;
+        std::uint8_t trailer[4];
+        putBe32(trailer, sum);
+        put(trailer, 4);
+    }
+
+    std::FILE* file_;
+    std::vector<std::uint8_t>& data_;
+    bool ok_ = true;
+};
+
+bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+std::unique_ptr<FrameEncoder> FrameEncoder::open(const std::string& output, int queue_depth)
+{
+    queue_depth = std::max(queue_depth, 1);
+    if (endsWith(output, ".png")) {
+        // 文件名自己拼，不把用户给的路径当 printf 格式串：只认唯一一个 %d / %0Nd 占位
+        SequenceName sequence;
+        std::size_t percent = output.find('%');
+        if (percent == std::string::npos) {
+            sequence.prefix = output.substr(0, output.size() - 4) + "_";
+            sequence.digits = 5;
+            sequence.suffix = ".png";
+        } else {
+            std::size_t end = percent + 1;
+            while (end < output.size() && output[end] >= '0' && output[end] <= '9')
+                ++end;
+            int width = end > percent + 1 ? std::atoi(output.substr(percent + 1, end - percent - 1).c_str()) : 1;
+            if (end >= output.size() || output[end] != 'd' || output.find('%', end) != std::string::npos ||
+                width < 1 || width > 12) {
+                std::cerr << "Bad image sequence name: " << output
+                          << " (use a single %d or %0Nd for the frame number)" << std::endl;
+                return nullptr;
+            }
+            sequence.prefix = output.substr(0, percent);
+            sequence.digits = width;
+            sequence.suffix = output.substr(end + 1);
+        }
+        return std::unique_ptr<FrameEncoder>(new FrameEncoder(nullptr, std::move(sequence), queue_depth));
+    }
+
+    std::FILE* stream = output == "-" ? stdout : std::fopen(output.c_str(), "wb");
+    if (!stream) {
+        std::cerr << "Failed to open capture output: " << output << std::endl;
+        return nullptr;
+    }
+    return std::unique_ptr<FrameEncoder>(new FrameEncoder(stream, SequenceName(), queue_depth));
+}
+
+FrameEncoder::FrameEncoder(std::FILE* stream, SequenceName sequence, int queue_depth)
+    : stream_(stream), sequence_(std::move(sequence)), queue_depth_(static_cast<std::size_t>(queue_depth))
+{
+    thread_ = std::thread(&FrameEncoder::encodeLoop, this);
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    finish();
+}
+
+void FrameEncoder::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_)
+            return;
+        stop_ = true;
+    }
+    ready_.notify_one();
+    thread_.join();
+    if (stream_) {
+        std::fflush(stream_);
+        if (stream_ != stdout)
+            std::fclose(stream_);
+        stream_ = nullptr;
+    }
+}
+
+bool FrameEncoder::submit(std::vector<std::uint8_t>& rgba, int width, int height, bool wait)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (wait) {
+        space_.wait(lock, [this] { return queue_.size() < queue_depth_ || failed_; });
+    }
+    if (stop_ || failed_ || queue_.size() >= queue_depth_) {
+        ++dropped_;
+        return false;
+    }
+
+    Frame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.rgba.swap(rgba);
+    queue_.push_back(std::move(frame));
+    if (!free_.empty()) {
+        rgba.swap(free_.back());
+        free_.pop_back();
+    }
+    lock.unlock();
+    ready_.notify_one();
+    return true;
+}
+
+void FrameEncoder::encodeLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+            return;  // 已要求退出且队列写完
+        Frame frame = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        bool ok = !failed_ && encode(frame);
+
+        lock.lock();
+        if (ok) {
+            ++written_;
+        } else {
+            failed_ = true;
+        }
+        free_.push_back(std::move(frame.rgba));
+        space_.notify_one();
+    }
+}
+
+bool FrameEncoder::encode(const Frame& frame)
+{
+    if (!isSequence()) {
+        if (first_width_ == 0) {
+            first_width_ = frame.width;
+            first_height_ = frame.height;
+        } else if (!size_warned_ && (frame.width != first_width_ || frame.height != first_height_)) {
+            std::cerr << "Capture size changed to " << frame.width << "x" << frame.height
+                      << "; the raw stream is no longer a single video size" << std::endl;
+            size_warned_ = true;
+        }
+        if (std::fwrite(frame.rgba.data(), 1, frame.rgba.size(), stream_) != frame.rgba.size()) {
+            std::cerr << "Failed to write captured frame " << written_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::string number = std::to_string(written_);
+    if (static_cast<int>(number.size()) < sequence_.digits)
+        number.insert(0, sequence_.digits - number.size(), '0');
+    std::string path = sequence_.prefix + number + sequence_.suffix;
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open capture image: " << path << std::endl;
+        return false;
+    }
+    bool ok = PngWriter(file, png_).write(frame.rgba.data(), frame.width, frame.height);
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+        std::cerr << "Failed to write capture image: " << path << std::endl;
+    return ok;
+}
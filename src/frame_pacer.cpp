@@ -0,0 +1,76 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <time.h>
+
+namespace {
+
+constexpr double kUncappedIdleWait = 1.0 / 120.0;  // 不限帧率时静止画面的轮询间隔
+
+}  // namespace
+
+FramePacer::FramePacer(double target_fps)
+    : interval_(target_fps > 0.0 ? 1.0 / target_fps : 0.0),
+      window_start_(-1.0),
+      window_cpu_start_(threadCpuSeconds())
+{
+}
+
+double FramePacer::threadCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+double FramePacer::untilNextFrame(double now) const
+{
+    return std::max(0.0, next_frame_ - now);
+}
+
+double FramePacer::idleWait() const
+{
+    return interval_ > 0.0 ? interval_ : kUncappedIdleWait;
+}
+
+void FramePacer::frameRendered(double now, double frame_seconds)
+{
+    ++rendered_;
+    frame_seconds_ += frame_seconds;
+    if (interval_ <= 0.0)
+        return;
+    // 按固定节拍推进；落后超过一帧时从当前时刻重新起步，不补画
+    next_frame_ += interval_;
+    if (next_frame_ < now)
+        next_frame_ = now + interval_;
+}
+
+void FramePacer::frameSkipped()
+{
+    ++skipped_;
+}
+
+bool FramePacer::sample(double now, FrameStats& stats)
+{
+    if (window_start_ < 0.0) {
+        window_start_ = now;
+        return false;
+    }
+    double elapsed = now - window_start_;
+    if (elapsed < 1.0)
+        return false;
+
+    double cpu = threadCpuSeconds();
+    stats.fps = rendered_ / elapsed;
+    stats.skipped_fps = skipped_ / elapsed;
+    stats.cpu_percent = std::clamp((cpu - window_cpu_start_) / elapsed * 100.0, 0.0, 100.0);
+    stats.saved_percent = 100.0 - stats.cpu_percent;
+    stats.frame_ms = rendered_ > 0 ? frame_seconds_ / rendered_ * 1000.0 : 0.0;
+
+    window_start_ = now;
+    window_cpu_start_ = cpu;
+    rendered_ = 0;
+    skipped_ = 0;
+    frame_seconds_ = 0.0;
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+FrameProfiler::~FrameProfiler()
+{
+    for (auto& slot : slots_) {
+        for (Sample& sample : slot) {
+            if (sample.query)
+                glDeleteQueries(1, &sample.query);
+        }
+    }
+}
+
+void FrameProfiler::Rolling::add(double value)
+{
+    values[next] = value;
+    next = (next + 1) % kWindow;
+    count = std::min(count + 1, kWindow);
+}
+
+double FrameProfiler::Rolling::mean() const
+{
+    if (count == 0)
+        return 0.0;
+    return std::accumulate(values.begin(), values.begin() + count, 0.0) / count;
+}
+
+double FrameProfiler::Rolling::max() const
+{
+    if (count == 0)
+        return 0.0;
+    return *std::max_element(values.begin(), values.begin() + count);
+}
+
+int FrameProfiler::addPass(const std::string& name, bool gpu)
+{
+    passes_.push_back(Pass{name, gpu, {}, {}, {}});
+    for (auto& slot : slots_) {
+        Sample sample;
+        if (gpu)
+            glGenQueries(1, &sample.query);
+        slot.push_back(sample);
+    }
+    return static_cast<int>(passes_.size()) - 1;
+}
+
+bool FrameProfiler::openCsv(const std::string& path)
+{
+    csv_.open(path);
+    if (!csv_) {
+        std::cerr << "Failed to open profile CSV: " << path << std::endl;
+        return false;
+    }
+    csv_ << "frame,pass,cpu_ms,gpu_ms\n";
+    return true;
+}
+
+void FrameProfiler::collect(int slot)
+{
+    for (std::size_t pass = 0; pass < passes_.size(); ++pass) {
+        Sample& sample = slots_[slot][pass];
+        if (!sample.ran)
+            continue;
+
+        double gpuMs = -1.0;
+        if (sample.query_issued) {
+            GLint available = 0;
+            glGetQueryObjectiv(sample.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(sample.query, GL_QUERY_RESULT, &nanoseconds);
+                gpuMs = static_cast<double>(nanoseconds) * 1e-6;
+                passes_[pass].gpu_time.add(gpuMs);
+            } else {
+                ++dropped_;
+            }
+        }
+        passes_[pass].cpu.add(sample.cpu_ms);
+
+        if (csv_.is_open()) {
+            csv_ << slot_frame_[slot] << ',' << passes_[pass].name << ',' << sample.cpu_ms << ',';
+            if (gpuMs >= 0.0)
+                csv_ << gpuMs;
+            csv_ << '\n';
+        }
+        sample.ran = false;
+        sample.cpu_ms = 0.0;
+        sample.query_issued = false;
+    }
+}
+
+void FrameProfiler::beginFrame()
+{
+    // 最旧的槽位已经等了 kLatency - 1 帧，取回结果后给本帧使用
+    slot_ = (slot_ + 1) % kLatency;
+    collect(slot_);
+    slot_frame_[slot_] = ++frame_;
+}
+
+void FrameProfiler::beginPass(int pass)
+{
+    Pass& info = passes_[pass];
+    if (info.gpu) {
+        glBeginQuery(GL_TIME_ELAPSED, slots_[slot_][pass].query);
+    }
+    info.started = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endPass(int pass)
+{
+    Pass& info = passes_[pass];
+    Sample& sample = slots_[slot_][pass];
+    // 同一帧内多次进入同一段时累加
+    sample.cpu_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - info.started).count();
+    sample.ran = true;
+    if (info.gpu) {
+        glEndQuery(GL_TIME_ELAPSED);
+        sample.query_issued = true;
+    }
+}
+
+std::vector<FrameProfiler::PassStats> FrameProfiler::stats() const
+{
+    std::vector<PassStats> result;
+    for (const Pass& pass : passes_) {
+        PassStats stats;
+        stats.name = pass.name;
+        stats.gpu = pass.gpu;
+        stats.cpu_mean_ms = pass.cpu.mean();
+        stats.cpu_max_ms = pass.cpu.max();
+        stats.gpu_mean_ms = pass.gpu_time.mean();
+        stats.gpu_max_ms = pass.gpu_time.max();
+        result.push_back(stats);
+    }
+    return result;
+}
+
+std::string FrameProfiler::summary() const
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << "pass         cpu ms (max)     gpu ms (max)";
+    for (const PassStats& pass : stats()) {
+        out << '\n' << std::left << std::setw(10) << pass.name << std::right
+            << std::setw(7) << pass.cpu_mean_ms << " (" << std::setw(6) << pass.cpu_max_ms << ")";
+        if (pass.gpu)
+            out << std::setw(9) << pass.gpu_mean_ms << " (" << std::setw(6) << pass.gpu_max_ms << ")";
+        else
+            out << "        -";
+    }
+    if (dropped_ > 0)
+        out << "\ngpu samples dropped " << dropped_;
+    return out.str();
+}
@@ -0,0 +1,79 @@
+#include "frame_readback.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameReadback::FrameReadback(int width, int height, int depth)
+    : width_(width),
+      height_(height),
+      buffers_(std::max(depth, 1)),
+      fences_(buffers_.size(), nullptr)
+{
+    glGenBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data());
+    for (GLuint buffer : buffers_) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(frameBytes()), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FrameReadback::~FrameReadback()
+{
+    for (GLsync fence : fences_) {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    glDeleteBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data());
+}
+
+bool FrameReadback::capture()
+{
+    if (pending_ == static_cast<int>(buffers_.size()))
+        return false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[head_]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // 目标是 PBO 时最后一个参数是缓冲内偏移，调用不等 GPU 画完就返回
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences_[head_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    head_ = (head_ + 1) % static_cast<int>(buffers_.size());
+    ++pending_;
+    return true;
+}
+
+bool FrameReadback::retrieve(std::vector<std::uint8_t>& rgba, bool wait)
+{
+    if (pending_ == 0)
+        return false;
+
+    int count = static_cast<int>(buffers_.size());
+    int oldest = (head_ - pending_ + count) % count;
+    GLsync& fence = fences_[oldest];
+    GLuint64 timeout = wait ? 1000000000ull : 0;
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    while (wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    }
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED)
+        return false;
+    glDeleteSync(fence);
+    fence = nullptr;
+
+    rgba.resize(frameBytes());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[oldest]);
+    auto* mapped = static_cast<const std::uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes()), GL_MAP_READ_BIT));
+    if (mapped) {
+        // OpenGL 的行序自下而上，翻转成图像文件和视频流通用的自上而下
+        std::size_t stride = static_cast<std::size_t>(width_) * 4;
+        for (int row = 0; row < height_; ++row) {
+            std::memcpy(rgba.data() + row * stride, mapped + (height_ - 1 - row) * stride, stride);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    --pending_;
+    return mapped != nullptr;
+}
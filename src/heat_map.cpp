@@ -0,0 +1,92 @@
+#include "heat_map.h"
+#include "Shader_m.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+HeatMap::HeatMap(const std::string& vertex_path, const std::string& fragment_path, int seats, int columns,
+                 int max_rows)
+    : seats_(std::max(seats, 1)),
+      columns_(std::max(columns, 2)),
+      rows_(std::clamp(seats, 1, std::max(max_rows, 1))),
+      row_sum_(rows_),
+      column_(rows_)
+{
+    Shader shader(vertex_path.c_str(), fragment_path.c_str());
+    program_ = shader.ID;
+    projection_location_ = glGetUniformLocation(program_, "projection");
+    rect_location_ = glGetUniformLocation(program_, "rect");
+    head_location_ = glGetUniformLocation(program_, "head");
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "heatSampler"), 0);
+    glUniform1f(glGetUniformLocation(program_, "columns"), static_cast<float>(columns_));
+
+    // 单通道字节纹理，初始全零；行宽不是 4 的倍数也能按字节上传
+    std::vector<std::uint8_t> zeros(static_cast<std::size_t>(columns_) * rows_, 0);
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, columns_, rows_, 0, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);  // 环形平移依赖横向重复
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const float corners[8] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    glGenVertexArrays(1, &vao_);
+    glBindVertexArray(vao_);
+    glGenBuffers(1, &vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+HeatMap::~HeatMap()
+{
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteTextures(1, &texture_);
+    glDeleteProgram(program_);
+}
+
+void HeatMap::push(std::span<const float> values)
+{
+    // 座位 s 落在第 s * rows / seats 行，每行取组内平均
+    std::fill(row_sum_.begin(), row_sum_.end(), 0.0f);
+    int count = std::min<int>(seats_, static_cast<int>(values.size()));
+    for (int seat = 0; seat < count; ++seat) {
+        int row = static_cast<int>(static_cast<std::int64_t>(seat) * rows_ / seats_);
+        row_sum_[row] += std::clamp(values[seat], 0.0f, 1.0f);
+    }
+    for (int row = 0; row < rows_; ++row) {
+        auto first = static_cast<std::int64_t>(row) * seats_ / rows_;
+        auto last = static_cast<std::int64_t>(row + 1) * seats_ / rows_;
+        float mean = row_sum_[row] / static_cast<float>(std::max<std::int64_t>(last - first, 1));
+        column_[row] = static_cast<std::uint8_t>(std::lround(mean * 255.0f));
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, head_, 0, 1, rows_, GL_RED, GL_UNSIGNED_BYTE, column_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    head_ = (head_ + 1) % columns_;
+}
+
+void HeatMap::draw(const glm::mat4& projection, glm::vec2 lower, glm::vec2 upper)
+{
+    glUseProgram(program_);
+    glUniformMatrix4fv(projection_location_, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform4f(rect_location_, lower.x, lower.y, upper.x, upper.y);
+    glUniform1f(head_location_, static_cast<float>(head_));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -4,111 +4,52 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include <cmath>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-#include "Shader_m.h"
 #include "philosopher.h"
+#include "chopstick_renderer.h"
+#include "frame_pacer.h"
+#include "frame_profiler.h"
+#include "frame_encoder.h"
+#include "frame_readback.h"
+#include "heat_map.h"
+#ifdef HAVE_EGL
+#include "offscreen_context.h"
+#endif
+#include "text_renderer.h"
+#include "seat_renderer.h"
+#include "sprite_batch.h"
+
+// 窗口尺寸变化或被遮挡后需要重画，即使模拟本身没有变化
+static bool windowDamaged = true;
 
 // ---------- 窗口回调 ----------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    windowDamaged = true;
 }
 
-// ---------- 创建圆形 VAO（带纹理坐标） ----------
-GLuint createCircleVAOWithTex(int segments, float radius) {
-    std::vector<float> vertices; // x, y, u, v
-
-    // 中心点
-    vertices.push_back(0.0f); vertices.push_back(0.0f);
-    vertices.push_back(0.5f); vertices.push_back(0.5f);
-
-    for(int i=0;i<=segments;i++){
-        float theta = 2.0f * M_PI * i / segments;
-        float x = radius * cos(theta);
-        float y = radius * sin(theta);
-        float u = 0.5f + 0.5f * cos(theta);
-        float v = 0.5f + 0.5f * sin(theta);
-        vertices.push_back(x); vertices.push_back(y);
-        vertices.push_back(u); vertices.push_back(v);
-    }
-
-    GLuint VAO,VBO;
-    glGenVertexArrays(1,&VAO);
-    glGenBuffers(1,&VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER,VBO);
-    glBufferData(GL_ARRAY_BUFFER,vertices.size()*sizeof(float),vertices.data(),GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,4*sizeof(float),(void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1,2,GL_FLOAT,GL_FALSE,4*sizeof(float),(void*)(2*sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    return VAO;
-}
-
-// ---------- 创建矩形 VAO ----------
-GLuint createRectangleVAO(float width, float height) {
-    float vertices[] = {
-        -width/2,-height/2,
-         width/2,-height/2,
-         width/2, height/2,
-        -width/2, height/2
-    };
-    GLuint indices[] = {0,1,2,2,3,0};
-    GLuint VAO,VBO,EBO;
-    glGenVertexArrays(1,&VAO);
-    glGenBuffers(1,&VBO);
-    glGenBuffers(1,&EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER,VBO);
-    glBufferData(GL_ARRAY_BUFFER,sizeof(vertices),vertices,GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,sizeof(indices),indices,GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,2*sizeof(float),(void*)0);
-    glEnableVertexAttribArray(0);
-
-    return VAO;
+void window_refresh_callback(GLFWwindow* window) {
+    windowDamaged = true;
 }
 
-// ---------- 创建带纹理坐标的矩形 VAO ----------
-GLuint createBillboardVAO(float width, float height) {
-    float vertices[] = {
-        // x, y, u, v
-        -width/2, -height/2, 0.0f, 0.0f,
-         width/2, -height/2, 1.0f, 0.0f,
-         width/2,  height/2, 1.0f, 1.0f,
-        -width/2,  height/2, 0.0f, 1.0f
-    };
-
-    GLuint indices[] = {0, 1, 2, 2, 3, 0};
-
-    GLuint VAO, VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    return VAO;
+// 程序启动以来的秒数；无窗口模式不初始化 GLFW，不能用 glfwGetTime
+double elapsedSeconds(){
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
 // ---------- 加载纹理 ----------
@@ -139,89 +80,169 @@ GLuint loadTexture(const std::filesystem::path& path){
     return textureID;
 }
 
-// ---------- 绘制对象 ----------
-void drawObject(GLuint shader, GLuint VAO, glm::mat4 transform, bool indexed, int vertexCount, GLuint textureID=0){
-    glUseProgram(shader);
-    GLint transLoc = glGetUniformLocation(shader,"transform");
-    if(transLoc!=-1) glUniformMatrix4fv(transLoc,1,GL_FALSE,glm::value_ptr(transform));
-
-    bool hasTexture = textureID != 0;
-    GLint hasTexLoc = glGetUniformLocation(shader,"hasTexture");
-    if(hasTexLoc!=-1){
-        glUniform1i(hasTexLoc, hasTexture ? 1 : 0);
-    }
+// ---------- 命令行参数 ----------
+struct ViewerConfig {
+    bool vsync = true;        // 交换缓冲时等待垂直同步
+    double max_fps = 60.0;    // 帧率上限，0 表示不限
+    int seats = 5;            // 座位数
+    ExecutionMode mode = ExecutionMode::THREADED;  // 座位很多时应改用 coroutine 或 pooled
+    std::string profile_csv;  // 非空时把每帧各段耗时写入该 CSV
+    bool headless = false;    // 不开窗口，离屏渲染并输出帧
+    int width = 800;          // 无窗口时的画面尺寸
+    int height = 800;
+    int frames = 300;         // 无窗口时录制的帧数
+    std::string output;       // 录制输出："-" 为标准输出，*.png 为图像序列，其他为原始 RGBA 文件；空则不录制
+};
+
+void printUsage(const char* argv0){
+    std::cerr << "用法: " << argv0 << " [--vsync on|off] [--fps N] [--seats N] [--mode threaded|coroutine|pooled]"
+              << " [--profile-csv path] [--output -|file.rgba|frame_%05d.png] [--headless [--size WxH] [--frames N]]"
+              << "  (N=0 不限帧率；运行时按 H 切换座位×时间饥饿热力图)" << std::endl;
+    std::cerr << "无窗口录制示例: " << argv0 << " --headless --output - | ffmpeg -f rawvideo -pixel_format rgba"
+              << " -video_size 800x800 -framerate 60 -i - philosophers.mp4" << std::endl;
+}
 
-    GLint solidLoc = glGetUniformLocation(shader,"solidColor");
-    if(solidLoc!=-1){
-        if(hasTexture){
-            glUniform4f(solidLoc,1.0f,1.0f,1.0f,1.0f);
-        }else{
-            glUniform4f(solidLoc,0.7f,0.5f,0.3f,1.0f);
+bool parseArgs(int argc, char** argv, ViewerConfig& config){
+    for(int i=1;i<argc;i++){
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--vsync" && hasValue){
+            std::string value = argv[++i];
+            if(value != "on" && value != "off")
+                return false;
+            config.vsync = value == "on";
+        } else if(arg == "--fps" && hasValue){
+            config.max_fps = std::atof(argv[++i]);
+        } else if(arg == "--profile-csv" && hasValue){
+            config.profile_csv = argv[++i];
+        } else if(arg == "--headless"){
+            config.headless = true;
+        } else if(arg == "--size" && hasValue){
+            if(std::sscanf(argv[++i], "%dx%d", &config.width, &config.height) != 2)
+                return false;
+        } else if(arg == "--frames" && hasValue){
+            config.frames = std::atoi(argv[++i]);
+        } else if(arg == "--output" && hasValue){
+            config.output = argv[++i];
+        } else if(arg == "--seats" && hasValue){
+            config.seats = std::atoi(argv[++i]);
+        } else if(arg == "--mode" && hasValue){
+            std::string mode = argv[++i];
+            if(mode == "threaded"){
+                config.mode = ExecutionMode::THREADED;
+            } else if(mode == "coroutine"){
+                config.mode = ExecutionMode::COROUTINE;
+            } else if(mode == "pooled"){
+                config.mode = ExecutionMode::POOLED;
+            } else {
+                return false;
+            }
+        } else {
+            return false;
         }
     }
+    if(config.headless && config.output.empty())
+        config.output = "-";
+    return config.max_fps >= 0.0 && config.seats >= 2 && config.width > 0 && config.height > 0 && config.frames > 0;
+}
 
-    if(hasTexture){
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D,textureID);
-        GLint texLoc = glGetUniformLocation(shader,"texSampler");
-        if(texLoc!=-1) glUniform1i(texLoc,0);
+// ---------- 文字渲染 ----------
+// 在 (x, y) 像素处写多行文字，先垫一块半透明底板保证在任何背景上都看得清
+void drawText(TextRenderer& renderer, float x, float y, const std::string& text){
+    const float padding = 6.0f;
+    int lines = 1 + static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+    std::size_t widest = 0, start = 0;
+    while(start <= text.size()){
+        std::size_t end = text.find('\n', start);
+        if(end == std::string::npos) end = text.size();
+        widest = std::max(widest, end - start);
+        start = end + 1;
     }
-    glBindVertexArray(VAO);
-    if(indexed){
-        glDrawElements(GL_TRIANGLES,vertexCount,GL_UNSIGNED_INT,0);
-    } else {
-        glDrawArrays(GL_TRIANGLE_FAN,0,vertexCount);
-    }
-    if(hasTexture) glBindTexture(GL_TEXTURE_2D,0);
+    renderer.addRect(x - padding, y - padding,
+                     widest * TextRenderer::glyphWidth() + 2 * padding,
+                     lines * TextRenderer::lineHeight() + 2 * padding, glm::vec4(0.0f, 0.0f, 0.0f, 0.55f));
+    renderer.addText(x, y, text, glm::vec4(1.0f, 1.0f, 0.85f, 1.0f));
 }
 
-// ---------- 占位文字渲染 ----------
-void drawText(float x,float y,const std::string &text){
-    // TODO: 使用 LearnOpenGL FreeType 渲染文字
-}
+int main(int argc, char** argv){
+    ViewerConfig config;
+    if(!parseArgs(argc, argv, config)){
+        printUsage(argv[0]);
+        return 1;
+    }
 
-int main(){
     namespace fs = std::filesystem;
     const fs::path projectRoot(PROJECT_ROOT);
     const fs::path shaderDir = projectRoot / "shaders";
     const fs::path imageDir = projectRoot / "Images";
 
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow* window = glfwCreateWindow(800,800,"哲学家进餐模拟器",NULL,NULL);
-    if(!window){ std::cerr<<"Failed to create window"<<std::endl; return -1;}
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window,framebuffer_size_callback);
-
-    if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
-        std::cerr<<"Failed to initialize GLAD"<<std::endl;
+    // 无窗口模式走 EGL 离屏上下文，window 保持为空
+    GLFWwindow* window = NULL;
+#ifdef HAVE_EGL
+    std::unique_ptr<OffscreenContext> offscreen;
+#endif
+    // 排在所有 GL 对象之前声明：局部对象逆序析构，合批、渲染器、读回等先删掉各自的 GL 对象，最后才销毁窗口和上下文
+    struct GlfwSession {
+        bool active = false;
+        ~GlfwSession(){ if(active) glfwTerminate(); }
+    } glfwSession;
+    if(config.headless){
+#ifdef HAVE_EGL
+        offscreen = OffscreenContext::create(config.width, config.height);
+        if(!offscreen) return -1;
+        if(!gladLoadGLLoader((GLADloadproc)OffscreenContext::procAddress)){
+            std::cerr<<"Failed to initialize GLAD"<<std::endl;
+            return -1;
+        }
+        if(!offscreen->createFramebuffer()) return -1;
+#else
+        std::cerr<<"Headless rendering needs EGL, which was not found at build time"<<std::endl;
         return -1;
+#endif
+    } else {
+        glfwInit();
+        glfwSession.active = true;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
+
+        const std::string windowTitle = "哲学家进餐模拟器";
+        window = glfwCreateWindow(800,800,windowTitle.c_str(),NULL,NULL);
+        if(!window){ std::cerr<<"Failed to create window"<<std::endl; return -1;}
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(config.vsync ? 1 : 0);
+        glfwSetFramebufferSizeCallback(window,framebuffer_size_callback);
+        glfwSetWindowRefreshCallback(window,window_refresh_callback);
+
+        if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
+            std::cerr<<"Failed to initialize GLAD"<<std::endl;
+            return -1;
+        }
     }
 
-    Shader ourShader(
-        (shaderDir / "basic.vs").string().c_str(),
-        (shaderDir / "basic.fs").string().c_str()
-    );
+    // 通用精灵合批（目前只有桌面）
+    SpriteBatch batch((shaderDir / "sprite.vs").string(), (shaderDir / "sprite.fs").string());
 
-    const int circleSegments = 50;
-    GLuint circleVAO = createCircleVAOWithTex(circleSegments,0.08f);
-    GLuint rectVAO = createRectangleVAO(0.03f,0.2f);
-    GLuint iconVAO = createBillboardVAO(0.18f,0.12f);
+    const float tableRadius = 0.4f;
+    const float radius = 0.75f;                            // 座位所在圆的半径
+    // 座位多到排不下时按比例缩小头像、图标和筷子，保持相邻座位不重叠
+    const float detailScale = std::min(1.0f, 0.9f * static_cast<float>(M_PI) * radius / config.seats / 0.08f);
+    const float seatRadius = 0.08f * detailScale;                           // 哲学家头像半径
+    const glm::vec2 chopstickHalfSize = glm::vec2(0.015f, 0.1f) * detailScale;  // 筷子 0.03 x 0.2
+    const glm::vec2 iconHalfSize = glm::vec2(0.09f, 0.06f) * detailScale;       // 状态图标 0.18 x 0.12
+    const float iconOffset = 0.18f * detailScale;
+    const glm::vec4 chopstickColor(0.7f, 0.5f, 0.3f, 1.0f);
 
     GLuint tableTexture = loadTexture(imageDir / "table.jpg");
-    std::vector<GLuint> philosopherTextures;
-    for(int i=1;i<=5;i++){
-        //std::string path = "philosopher" + std::to_string(i) + ".png";
-        philosopherTextures.push_back(loadTexture(imageDir / "philosopher.jpeg"));
-    }
+    GLuint philosopherTexture = loadTexture(imageDir / "philosopher.jpeg");  // 所有座位共用，合成一次绘制
     GLuint thinkingTexture = loadTexture(imageDir / "thinking.png");
     GLuint eatingTexture   = loadTexture(imageDir / "eating.png");
     GLuint hungryTexture    = loadTexture(imageDir / "hungry.png");
 
-    PhilosopherManager manager(5);
+    SimulationOptions options;
+    options.mode = config.mode;
+    options.track_changes = true;  // 渲染端按座位变化计数增量更新
+    PhilosopherManager manager(config.seats, options);
     manager.start();
 
     glEnable(GL_BLEND);
@@ -229,101 +250,270 @@ int main(){
 
     float rotation = 0.0f;
 
-    std::vector<glm::vec2> chopstickPositions;
-    chopstickPositions.resize(manager.getNumPhilosophers(), glm::vec2(0.0f));
-    bool chopsticksInitialized = false;
-
-    while(!glfwWindowShouldClose(window)){
-        if(glfwGetKey(window,GLFW_KEY_ESCAPE)==GLFW_PRESS)
-            glfwSetWindowShouldClose(window,true);
-
-        glClearColor(0.2f,0.3f,0.3f,1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        int n = manager.getNumPhilosophers();
-        float radius = 0.75f;
-
-        // --- 绘制桌子 ---
-        glm::mat4 tableTransform = glm::mat4(1.0f);
-        /* 原始桌面尺寸较小，通过缩放矩阵放大整体桌面 */
-        tableTransform = glm::scale(tableTransform, glm::vec3(5.0f,5.0f,1.0f));
-        drawObject(ourShader.ID,circleVAO,tableTransform,false,circleSegments+2,tableTexture);
-
-        // --- 绘制筷子 ---
-        for(int i=0;i<n;i++){
-
-            float angleCurrent = 2*M_PI*i/n;
-            float angleNext = 2*M_PI*((i+1)%n)/n;
+    // 座位与筷子静止位置只算一次，筷子的移动交给顶点着色器
+    int n = manager.getNumPhilosophers();
+    std::vector<glm::vec2> seatPositions(n);
+    std::vector<glm::vec2> chopstickRest(n);
+    for(int i=0;i<n;i++){
+        float angle = 2*M_PI*i/n;
+        seatPositions[i] = glm::vec2(radius*cos(angle), radius*sin(angle));
+    }
+    for(int i=0;i<n;i++){
+        chopstickRest[i] = (seatPositions[i] + seatPositions[(i+1)%n]) * 0.5f;
+    }
+    ChopstickRenderer chopsticks((shaderDir / "chopstick.vs").string(), (shaderDir / "chopstick.fs").string(),
+                                 seatPositions, chopstickRest, chopstickHalfSize, chopstickColor);
+    SeatRenderer seats((shaderDir / "seat.vs").string(), (shaderDir / "seat.fs").string(), seatPositions,
+                       seatRadius, iconHalfSize, iconOffset, philosopherTexture,
+                       {thinkingTexture, hungryTexture, eatingTexture});
+
+    // 增量更新：管理器按位图给出变化过的座位，只读这些座位
+    std::vector<int> changedSeats;
+    FramePacer pacer(config.max_fps);
+    FrameStats frameStats;
+    SeatLod lod = SeatLod::FULL;
+    const char* lodNames[] = {"portraits", "points", "ring"};  // HUD 字体只有 ASCII
+
+    // 性能 HUD：每秒汇总一次，文字和底板一次绘制
+    TextRenderer text((shaderDir / "text.vs").string(), (shaderDir / "text.fs").string());
+    std::string hudText;
+    long long lastMeals = 0;
+    double lastHudTime = elapsedSeconds();
+    std::vector<double> eatCounts(n, 0.0);
+
+    // 分段计时：CPU 段看状态轮询和交换缓冲，GPU 段看每个绘制阶段
+    FrameProfiler profiler;
+    const int pollPass = profiler.addPass("poll", false);
+    const int heatPass = profiler.addPass("heatmap", true);
+    const int tablePass = profiler.addPass("table", true);
+    const int chopstickPass = profiler.addPass("chopsticks", true);
+    const int seatPass = profiler.addPass("seats", true);
+    const int hudPass = profiler.addPass("hud", true);
+    const int capturePass = profiler.addPass("capture", false);
+    const int swapPass = profiler.addPass("swap", false);
+    if(!config.profile_csv.empty() && !profiler.openCsv(config.profile_csv))
+        return 1;
+
+    // 热力图：每 0.25 秒一列，颜色为该区间内饥饿时间所占比例，按 H 与桌面视图切换
+    HeatMap heatMap((shaderDir / "heatmap.vs").string(), (shaderDir / "heatmap.fs").string(), n);
+    const double heatInterval = 0.25;
+    double nextHeatSample = elapsedSeconds() + heatInterval;
+    std::vector<std::int64_t> lastHungryNs(n, 0);
+    std::vector<float> hungryFraction(n, 0.0f);
+    bool heatView = false;
+    bool heatKeyDown = false;
+
+    // 录制：帧读回走像素缓冲对象，几帧之后 GPU 早已画完才映射；写文件和 PNG 打包交给后台编码线程
+    bool recording = !config.output.empty();
+    std::unique_ptr<FrameReadback> readback;
+    std::unique_ptr<FrameEncoder> encoder;
+    std::vector<std::uint8_t> framePixels;
+    int framesRendered = 0;
+    if(recording){
+        encoder = FrameEncoder::open(config.output);
+        if(!encoder) return 1;
+    }
+    // 取回最旧的一帧交给编码线程；wait 为 false 且 GPU 还没画完时什么也不做。
+    // 窗口录制时编码队列满了就丢帧，交互帧率不受磁盘影响；无窗口录制一帧不丢
+    auto encodeFrame = [&](bool wait){
+        if(!readback->retrieve(framePixels, wait))
+            return false;
+        encoder->submit(framePixels, readback->width(), readback->height(), wait || !window);
+        return true;
+    };
 
-            glm::vec2 posCurrent(radius*cos(angleCurrent), radius*sin(angleCurrent));
-            glm::vec2 posNext(radius*cos(angleNext), radius*sin(angleNext));
-            glm::vec2 defaultMid = (posCurrent + posNext) * 0.5f;
+    while(window ? !glfwWindowShouldClose(window) : framesRendered < config.frames){
+        // 帧率上限：在事件等待里度过剩余的帧间隔，不空转
+        double wait = pacer.untilNextFrame(elapsedSeconds());
+        if(wait > 0.0){
+            if(window)
+                glfwWaitEventsTimeout(wait);
+            else
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+        }
 
-            if(!chopsticksInitialized){
-                chopstickPositions[i] = defaultMid;
+        if(window){
+            if(glfwGetKey(window,GLFW_KEY_ESCAPE)==GLFW_PRESS)
+                glfwSetWindowShouldClose(window,true);
+            bool heatKey = glfwGetKey(window,GLFW_KEY_H)==GLFW_PRESS;
+            if(heatKey && !heatKeyDown){
+                heatView = !heatView;
+                windowDamaged = true;
             }
+            heatKeyDown = heatKey;
+        }
 
-            glm::vec2 targetPos = defaultMid;
-            int owner = manager.getChopstickOwner(i);
-            if(owner >= 0){
-                float ownerAngle = 2*M_PI*owner/n;
-                glm::vec2 ownerPos(radius*cos(ownerAngle), radius*sin(ownerAngle));
-                targetPos = defaultMid + (ownerPos - defaultMid) * 0.5f;
+        profiler.beginFrame();
+        double clock = elapsedSeconds();
+        float now = static_cast<float>(clock);
+        bool changed = false;
+        profiler.beginPass(pollPass);
+        if(pacer.sample(clock, frameStats)){
+            long long meals = 0;
+            for(int i=0;i<n;i++){
+                eatCounts[i] = manager.getPhilosopherEatCount(i);
+                meals += manager.getPhilosopherEatCount(i);
             }
+            auto [fewest, most] = std::minmax_element(eatCounts.begin(), eatCounts.end());
+            WaitSummary waits = manager.getWaitStats().summary();
+
+            std::ostringstream hud;
+            hud << std::fixed << std::setprecision(1)
+                << "meals/s   " << (meals - lastMeals) / (clock - lastHudTime) << "\n"
+                << "wait p99  ";
+            if(waits.samples > 0)
+                hud << waits.p99_ms << " ms (mean " << waits.mean_ms << ")\n";
+            else
+                hud << "n/a (threaded mode only)\n";
+            hud << std::setprecision(3) << "fairness  " << jainIndex(eatCounts) << " (Jain)\n"
+                << std::setprecision(2) << "frame     " << frameStats.frame_ms << " ms, "
+                << std::setprecision(0) << frameStats.fps << " fps, " << frameStats.skipped_fps << " idle/s\n"
+                << "cpu       " << frameStats.cpu_percent << "% render thread, "
+                << frameStats.saved_percent << "% saved\n"
+                << "seats     " << n << " (" << (heatView ? "heat map" : lodNames[static_cast<int>(lod)]) << ")\n";
+            if(n <= 16){
+                for(int i=0;i<n;i++){
+                    hud << "  #" << std::setw(2) << i << " " << std::setw(5) << eatCounts[i] << ((i % 4 == 3 || i == n - 1) ? "\n" : "");
+                }
+            } else {
+                hud << "eats      min " << *fewest << " / mean " << meals / static_cast<double>(n) << " / max " << *most << "\n";
+            }
+            if(encoder)
+                hud << "capture   " << encoder->written() << " frames, " << encoder->dropped() << " dropped\n";
+            hud << profiler.summary();
+            hudText = hud.str();
+            lastMeals = meals;
+            lastHudTime = clock;
+            changed = true;
+        }
+        changedSeats.clear();
+        manager.takeChangedSeats(changedSeats);
+        for(int i : changedSeats){
+            seats.setState(i, manager.getPhilosopherState(i));
+            for(int chopstick : manager.chopsticksFor(i)){
+                chopsticks.setOwner(chopstick, manager.getChopstickOwner(chopstick), now);
+            }
+            changed = true;
+        }
 
-            chopstickPositions[i] += (targetPos - chopstickPositions[i]) * 0.15f;
-
-            glm::mat4 transform = glm::mat4(1.0f);
-            transform = glm::translate(transform, glm::vec3(chopstickPositions[i].x, chopstickPositions[i].y, 0.0f));
+        // 热力图按固定间隔追加一列，只上传这一列
+        if(clock >= nextHeatSample){
+            double interval = heatInterval + (clock - nextHeatSample);
+            for(int i=0;i<n;i++){
+                std::int64_t hungryNs = manager.getHungryTime(i).count();
+                hungryFraction[i] = static_cast<float>(std::max<std::int64_t>(0, hungryNs - lastHungryNs[i]) / (interval * 1e9));
+                lastHungryNs[i] = std::max(lastHungryNs[i], hungryNs);
+            }
+            heatMap.push(hungryFraction);
+            nextHeatSample = clock + heatInterval;
+            changed = changed || heatView;
+        }
 
-            glm::vec2 toCenter = -chopstickPositions[i];
-            float orientation = std::atan2(toCenter.y, toCenter.x) - glm::half_pi<float>();
-            transform = glm::rotate(transform, orientation, glm::vec3(0,0,1));
+        profiler.endPass(pollPass);
 
-            drawObject(ourShader.ID,rectVAO,transform,true,6);
+        // 没有变化、没有筷子在移动、窗口也不需要重画时跳过整帧；录制时每帧都要输出
+        bool animating = !heatView && lod == SeatLod::FULL && chopsticks.animating(now);  // 筷子不画时不必等缓动结束
+        if(!recording && !changed && !windowDamaged && !animating){
+            pacer.frameSkipped();
+            glfwWaitEventsTimeout(pacer.idleWait());
+            continue;
         }
-        chopsticksInitialized = true;
-
-        // --- 绘制哲学家 ---
-        for(int i=0;i<n;i++){
-            float angle = 2*M_PI*i/n;
-            glm::vec2 pos(radius*cos(angle),radius*sin(angle));
-            glm::mat4 transform = glm::mat4(1.0f);
-            transform = glm::translate(transform,glm::vec3(pos.x,pos.y,0.0f));
-            drawObject(ourShader.ID,circleVAO,transform,false,circleSegments+2,philosopherTextures[i]);
-
-            PhilosopherState state = manager.getPhilosopherState(i);
-            GLuint stateTexture = 0;
-            if(state == PhilosopherState::THINKING){
-                stateTexture = thinkingTexture;
-            } else if(state == PhilosopherState::EATING){
-                stateTexture = eatingTexture;
-            }else if(state == PhilosopherState::HUNGRY){
-                stateTexture = hungryTexture;
-            }
+        windowDamaged = false;
 
-            if(stateTexture != 0){
-                glm::vec2 direction = glm::length(pos) > 0.0f ? glm::normalize(pos) : glm::vec2(0.0f, 1.0f);
-                glm::vec3 iconPos = glm::vec3(pos + direction * 0.18f, 0.0f);
+#ifdef HAVE_EGL
+        if(offscreen)
+            offscreen->bind();  // 无窗口时每帧都画进离屏帧缓冲，读回也从它读
+#endif
+        glClearColor(0.2f,0.3f,0.3f,1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        const glm::mat4 projection(1.0f);
+        int fbWidth = config.width, fbHeight = config.height;
+        if(window)
+            glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+
+        if(heatView){
+            // 纵轴座位（0 号在上），横轴时间（最新在右）
+            FrameProfiler::Scope scope(profiler, heatPass);
+            heatMap.draw(projection, glm::vec2(-0.95f, -0.95f), glm::vec2(0.95f, 0.95f));
+        } else {
+            // --- 绘制桌子 ---
+            /* 原始桌面尺寸较小，放大 5 倍 */
+            profiler.beginPass(tablePass);
+            batch.begin();
+            Sprite table;
+            table.center = glm::vec2(0.0f);
+            table.half_size = glm::vec2(tableRadius);
+            table.texture = tableTexture;
+            table.circle = true;
+            table.layer = 0;
+            batch.add(table);
+            batch.flush(projection);
+            profiler.endPass(tablePass);
+
+            // --- 绘制筷子和哲学家：只上传变化过的实例数据 ---
+            // 按较短边换算像素尺寸，座位只有几个像素时筷子不画，座位退化成点或圆环
+            float pixelsPerUnit = 0.5f * static_cast<float>(std::min(fbWidth, fbHeight));
+            lod = seats.lodFor(pixelsPerUnit);
+            if(lod == SeatLod::FULL){
+                FrameProfiler::Scope scope(profiler, chopstickPass);
+                chopsticks.draw(projection, now);
+            }
+            {
+                FrameProfiler::Scope scope(profiler, seatPass);
+                seats.draw(projection, pixelsPerUnit);
+            }
+        }
 
-                glm::mat4 iconTransform = glm::mat4(1.0f);
-                iconTransform = glm::translate(iconTransform, iconPos);
-                drawObject(ourShader.ID, iconVAO, iconTransform, true, 6, stateTexture);
+        // --- 性能 HUD ---
+        profiler.beginPass(hudPass);
+        text.begin();
+        drawText(text, 16.0f, 16.0f, hudText);
+        text.flush(fbWidth, fbHeight);
+        profiler.endPass(hudPass);
+
+        if(recording){
+            profiler.beginPass(capturePass);
+            // 窗口尺寸变了：先取完在途的帧，再按新尺寸重建读回环
+            if(!readback || readback->width() != fbWidth || readback->height() != fbHeight){
+                while(readback && readback->pending() > 0 && encodeFrame(true)){}
+                readback = std::make_unique<FrameReadback>(fbWidth, fbHeight);
             }
+            // 平时只取 GPU 已经完成的帧；读回环满时无窗口录制等最旧的一帧，窗口录制丢掉这一帧
+            while(encodeFrame(false)){}
+            bool captured = readback->capture();
+            if(!captured && !window)
+                captured = encodeFrame(true) && readback->capture();
+            profiler.endPass(capturePass);
+            if(!window && (!captured || encoder->failed()))
+                break;
+            if(encoder->failed())
+                recording = false;  // 窗口继续运行，只停止录制
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        profiler.beginPass(swapPass);
+        if(window)
+            glfwSwapBuffers(window);
+        ++framesRendered;
+        profiler.endPass(swapPass);
+        pacer.frameRendered(clock, elapsedSeconds() - clock);
+        if(window)
+            glfwPollEvents();
+    }
+
+    if(encoder){
+        while(recording && readback && readback->pending() > 0 && encodeFrame(true)){}
+        encoder->finish();
+        std::cerr<<"Captured "<<encoder->written()<<" frames";
+        if(encoder->dropped() > 0)
+            std::cerr<<", dropped "<<encoder->dropped();
+        std::cerr<<std::endl;
     }
 
     manager.stop();
-    glDeleteVertexArrays(1,&circleVAO);
-    glDeleteVertexArrays(1,&rectVAO);
-    glDeleteVertexArrays(1,&iconVAO);
+    glDeleteTextures(1,&tableTexture);
+    glDeleteTextures(1,&philosopherTexture);
     glDeleteTextures(1,&thinkingTexture);
     glDeleteTextures(1,&eatingTexture);
     glDeleteTextures(1,&hungryTexture);
-
-    glfwTerminate();
     return 0;
 }
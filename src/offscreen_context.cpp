@@ -0,0 +1,148 @@
+#include "offscreen_context.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool hasExtension(const char* list, const char* name)
+{
+    if (!list)
+        return false;
+    std::size_t length = std::strlen(name);
+    for (const char* at = std::strstr(list, name); at; at = std::strstr(at + 1, name)) {
+        bool startOk = at == list || at[-1] == ' ';
+        bool endOk = at[length] == ' ' || at[length] == '\0';
+        if (startOk && endOk)
+            return true;
+    }
+    return false;
+}
+
+EGLDisplay openDisplay()
+{
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+                return display;
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        return display;
+    return EGL_NO_DISPLAY;
+}
+
+}  // namespace
+
+std::unique_ptr<OffscreenContext> OffscreenContext::create(int width, int height)
+{
+    std::unique_ptr<OffscreenContext> offscreen(new OffscreenContext(width, height));
+
+    EGLDisplay display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        std::cerr << "Failed to initialize an EGL display" << std::endl;
+        return nullptr;
+    }
+    offscreen->display_ = display;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL display does not support desktop OpenGL" << std::endl;
+        return nullptr;
+    }
+
+    // 先要能建 pbuffer 的配置，找不到再放宽，随后走无表面上下文
+    const EGLint pbufferAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+                                     EGL_NONE};
+    const EGLint anyAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint count = 0;
+    bool pbuffer = eglChooseConfig(display, pbufferAttribs, &config, 1, &count) && count > 0;
+    if (!pbuffer && !(eglChooseConfig(display, anyAttribs, &config, 1, &count) && count > 0)) {
+        std::cerr << "No EGL config supports desktop OpenGL" << std::endl;
+        return nullptr;
+    }
+
+    const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                     EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                     EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create an OpenGL 3.3 core context through EGL" << std::endl;
+        return nullptr;
+    }
+    offscreen->context_ = context;
+
+    // 真正的渲染目标是帧缓冲对象，pbuffer 只为满足不支持无表面上下文的实现，1x1 即可
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (pbuffer) {
+        const EGLint surfaceAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    }
+    if (surface == EGL_NO_SURFACE &&
+        !hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        std::cerr << "EGL supports neither pbuffers nor surfaceless contexts" << std::endl;
+        return nullptr;
+    }
+    offscreen->surface_ = surface;
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        std::cerr << "Failed to make the EGL context current" << std::endl;
+        return nullptr;
+    }
+    return offscreen;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+    auto display = static_cast<EGLDisplay>(display_);
+    if (!display)
+        return;
+    if (context_) {
+        if (framebuffer_) {
+            glDeleteFramebuffers(1, &framebuffer_);
+            glDeleteRenderbuffers(1, &color_);
+        }
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, static_cast<EGLContext>(context_));
+    }
+    if (surface_)
+        eglDestroySurface(display, static_cast<EGLSurface>(surface_));
+    eglTerminate(display);
+}
+
+void* OffscreenContext::procAddress(const char* name)
+{
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+bool OffscreenContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &color_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, width_, height_);
+    return true;
+}
+
+void OffscreenContext::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+}
@@ -0,0 +1,292 @@
+#include "parallel_des.h"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+}  // namespace
+
+ParallelDesSimulation::ParallelDesSimulation(const DesOptions& options)
+    : options_(options),
+      topology_(options.topology ? options.topology
+                                 : std::make_shared<const ResourceTopology>(ResourceTopology::ring(
+                                       static_cast<int>(std::max<std::int64_t>(options.num_seats, 2))))),
+      num_seats_(topology_->numSeats()),
+      end_time_(static_cast<std::uint64_t>(options.virtual_seconds * 1e6)),
+      lookahead_(std::min(options.think.minMicros(), options.eat.minMicros())),
+      seats_(static_cast<std::size_t>(num_seats_), options.seed),
+      chopstick_owner_(topology_->numResources(), -1),
+      window_end_(0),
+      windows_(0),
+      done_(false)
+{
+    // 没有前瞻量时零时长的新事件会落进当前窗口，只能顺序模拟；窗口至少 1 微秒
+    int count = static_cast<int>(std::clamp<std::int64_t>(options_.partitions, 1, num_seats_));
+    if (lookahead_ == 0) {
+        count = 1;
+        lookahead_ = 1;
+    }
+    partitions_.resize(count);
+    frontier_ = std::vector<Frontier>(count);
+    for (int p = 0; p < count; ++p) {
+        partitions_[p].begin = num_seats_ * p / count;
+        partitions_[p].end = num_seats_ * (p + 1) / count;
+    }
+    if (count > 1)
+        markExposedSeats();
+
+    int seats = static_cast<int>(num_seats_);
+    if (options_.think.isTrace()) {
+        think_cursor_.resize(num_seats_);
+        for (int seat = 0; seat < seats; ++seat)
+            think_cursor_[seat] = options_.think.startCursor(seat, seats);
+    }
+    if (options_.eat.isTrace()) {
+        eat_cursor_.resize(num_seats_);
+        for (int seat = 0; seat < seats; ++seat)
+            eat_cursor_[seat] = options_.eat.startCursor(seat, seats);
+    }
+
+    for (Partition& partition : partitions_) {
+        for (std::int64_t seat = partition.begin; seat < partition.end; ++seat) {
+            partition.events.push(Event{sample(seat, options_.think, think_cursor_), seat, THINK_DONE});
+        }
+    }
+}
+
+void ParallelDesSimulation::markExposedSeats()
+{
+    // 先找出有外段邻座的座位，再向外扩两层：与它距离 2 以内的座位到外段的距离都不超过 3
+    std::vector<std::int8_t> distance(static_cast<std::size_t>(num_seats_), -1);
+    std::vector<std::int64_t> layer;
+    for (std::int64_t seat = 0; seat < num_seats_; ++seat) {
+        int home = partitionOf(seat);
+        for (int chopstick : chopsticksOf(seat)) {
+            for (int other : topology_->usersOf(chopstick)) {
+                if (distance[seat] < 0 && partitionOf(other) != home) {
+                    distance[seat] = 0;
+                    layer.push_back(seat);
+                }
+            }
+        }
+    }
+    for (std::int8_t depth = 1; depth <= 2; ++depth) {
+        std::vector<std::int64_t> next;
+        for (std::int64_t seat : layer) {
+            for (int chopstick : chopsticksOf(seat)) {
+                for (int other : topology_->usersOf(chopstick)) {
+                    if (distance[other] < 0) {
+                        distance[other] = depth;
+                        next.push_back(other);
+                    }
+                }
+            }
+        }
+        layer.swap(next);
+    }
+
+    exposed_.resize(static_cast<std::size_t>(num_seats_));
+    for (std::int64_t seat = 0; seat < num_seats_; ++seat) {
+        exposed_[seat] = distance[seat] >= 0;
+    }
+}
+
+int ParallelDesSimulation::partitionOf(std::int64_t seat) const
+{
+    int count = static_cast<int>(partitions_.size());
+    int p = static_cast<int>(seat * count / num_seats_);
+    while (p + 1 < count && partitions_[p + 1].begin <= seat)
+        ++p;
+    while (p > 0 && partitions_[p].begin > seat)
+        --p;
+    return p;
+}
+
+std::uint64_t ParallelDesSimulation::sample(std::int64_t seat, const DurationDistribution& distribution,
+                                            std::vector<DurationDistribution::Cursor>& cursors)
+{
+    std::uint32_t r = seats_.rng(static_cast<std::size_t>(seat))();
+    if (cursors.empty())
+        return distribution.sampleMicros(r);
+    return distribution.nextMicros(r, cursors[seat]);
+}
+
+DesResult ParallelDesSimulation::run()
+{
+    auto begin = std::chrono::steady_clock::now();
+
+    completeWindow();  // 计算第一个窗口并公布各段起点，这次不计入窗口数
+    windows_ = 0;
+
+    std::barrier sync(static_cast<std::ptrdiff_t>(partitions_.size()), [this]() noexcept { completeWindow(); });
+    auto loop = [this, &sync](int index) {
+        while (!done_) {
+            processWindow(index);
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int p = 1; p < static_cast<int>(partitions_.size()); ++p) {
+        threads.emplace_back(loop, p);
+    }
+    loop(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    DesResult result;
+    result.eat_counts.resize(seats_.size());
+    for (std::size_t seat = 0; seat < seats_.size(); ++seat) {
+        result.eat_counts[seat] = seats_.eatCount(seat);
+        result.meals += result.eat_counts[seat];
+    }
+    result.seat_bytes = CompactSeatTable::bytesPerSeat();
+    for (const Partition& partition : partitions_) {
+        result.events += partition.processed;
+        result.exposed_events += partition.exposed;
+        result.stalls += partition.stalls;
+    }
+    result.windows = windows_;
+    result.partitions = static_cast<int>(partitions_.size());
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+void ParallelDesSimulation::processWindow(int index)
+{
+    Partition& partition = partitions_[index];
+    while (!partition.events.empty() && partition.events.top().time < window_end_) {
+        Event event = partition.events.top();
+        if (!exposed_.empty() && exposed_[event.seat]) {
+            waitForTurn(index, event);
+            ++partition.exposed;
+        }
+        partition.events.pop();
+        ++partition.processed;
+
+        if (event.type == THINK_DONE) {
+            seats_.setState(event.seat, HUNGRY);
+            tryEat(index, event.seat, event.time);
+        } else {
+            std::span<const int> chopsticks = chopsticksOf(event.seat);
+            seats_.addMeal(event.seat);
+            seats_.setState(event.seat, THINKING);
+            for (int chopstick : chopsticks) {
+                chopstick_owner_[chopstick] = -1;
+            }
+            partition.events.push(Event{event.time + sample(event.seat, options_.think, think_cursor_),
+                                        event.seat, THINK_DONE});
+            for (int chopstick : chopsticks) {
+                wakeNeighbours(index, chopstick, event.seat, event.time);
+            }
+        }
+        publishFrontier(index);
+    }
+}
+
+void ParallelDesSimulation::publishFrontier(int index)
+{
+    // 新事件都不早于窗口结束，所以公布的时刻在窗口内只增不减
+    const Partition& partition = partitions_[index];
+    std::uint64_t next = partition.events.empty() ? window_end_ : std::min(partition.events.top().time, window_end_);
+    frontier_[index].time.store(next, std::memory_order_release);
+}
+
+void ParallelDesSimulation::waitForTurn(int index, const Event& event)
+{
+    // 其他段都越过这个事件后才能处理：时刻更晚，或时刻相同但座位编号更大（分段按编号排列）
+    bool stalled = false;
+    for (int other = 0; other < static_cast<int>(partitions_.size()); ++other) {
+        if (other == index)
+            continue;
+        for (int spin = 0;; ++spin) {
+            std::uint64_t time = frontier_[other].time.load(std::memory_order_acquire);
+            if (time > event.time || (time == event.time && other > index))
+                break;
+            stalled = true;
+            if (spin < 64) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    if (stalled)
+        ++partitions_[index].stalls;
+}
+
+bool ParallelDesSimulation::allFree(std::int64_t seat) const
+{
+    for (int chopstick : chopsticksOf(seat)) {
+        if (chopstick_owner_[chopstick] >= 0)
+            return false;
+    }
+    return true;
+}
+
+void ParallelDesSimulation::tryEat(int index, std::int64_t seat, std::uint64_t now)
+{
+    if (allFree(seat)) {
+        startEating(index, seat, now);
+    }
+}
+
+void ParallelDesSimulation::wakeNeighbours(int index, int chopstick, std::int64_t releaser, std::uint64_t now)
+{
+    for (int other : topology_->usersOf(chopstick)) {
+        if (other != releaser && seats_.state(other) == HUNGRY) {
+            tryEat(index, other, now);
+        }
+    }
+}
+
+void ParallelDesSimulation::startEating(int index, std::int64_t seat, std::uint64_t now)
+{
+    for (int chopstick : chopsticksOf(seat)) {
+        chopstick_owner_[chopstick] = static_cast<std::int32_t>(seat);
+    }
+    seats_.setState(seat, EATING);
+    Event done{now + sample(seat, options_.eat, eat_cursor_), seat, EAT_DONE};
+    Partition& partition = partitions_[index];
+    if (seat >= partition.begin && seat < partition.end) {
+        partition.events.push(done);
+    } else {
+        partition.outbox.push_back(done);  // 外段座位的事件队列归它的线程，窗口结束后再投递
+    }
+}
+
+void ParallelDesSimulation::completeWindow()
+{
+    ++windows_;
+
+    for (Partition& partition : partitions_) {
+        for (const Event& event : partition.outbox) {
+            partitions_[partitionOf(event.seat)].events.push(event);
+        }
+        partition.outbox.clear();
+    }
+
+    std::uint64_t next = end_time_;
+    for (Partition& partition : partitions_) {
+        if (!partition.events.empty())
+            next = std::min(next, partition.events.top().time);
+    }
+    done_ = next >= end_time_;
+    window_end_ = std::min(next + lookahead_, end_time_);
+    for (int p = 0; p < static_cast<int>(partitions_.size()); ++p) {
+        publishFrontier(p);
+    }
+}
@@ -1,20 +1,59 @@
 #include "philosopher.h"
+#include "coro_scheduler.h"
+#include "cpu_topology.h"
+#include "work_stealing_pool.h"
 
+#include <algorithm>
+#include <bit>
+#include <cerrno>
 #include <chrono>
+#include <ctime>
 #include <iostream>
 #include <memory>
 #include <thread>
 
-Philosopher::Philosopher(int id, int num_philosophers, PhilosopherManager& manager)
+namespace {
+
+// 等待切片：阻塞等待被拆成若干短片，每片结束后检查截止时间和取消令牌
+constexpr std::chrono::milliseconds kWaitSlice(5);
+
+bool shouldGiveUp(std::chrono::steady_clock::time_point deadline, const CancellationToken* token)
+{
+    return (token && token->isCancelled()) || std::chrono::steady_clock::now() >= deadline;
+}
+
+std::chrono::steady_clock::time_point nextSliceEnd(std::chrono::steady_clock::time_point deadline)
+{
+    auto now = std::chrono::steady_clock::now();
+    return now + std::min<std::chrono::steady_clock::duration>(kWaitSlice, deadline - now);
+}
+
+std::int64_t steadyNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+Philosopher::Philosopher(int id, int num_philosophers, PhilosopherManager& manager,
+                         const SimulationOptions& options)
     : id_(id),
       num_philosophers_(num_philosophers),
       manager_(manager),
       state_(PhilosopherState::THINKING),
       running_(false),
       eat_count_(0),
-      gen_(rd_()),
-      think_dist_(1000, 5000),  // 思考 s
-      eat_dist_(1000, 3000)     // 进餐 s
+      vacant_(false),
+      hungry_timeout_(0),
+      cpu_(-1),
+      hungry_since_ns_(0),
+      hungry_total_ns_(0),
+      gen_(mixSeed(options.seed ^ static_cast<std::uint64_t>(id))),
+      think_dist_(options.think_duration),
+      eat_dist_(options.eat_duration),
+      think_cursor_(think_dist_.startCursor(id, num_philosophers)),
+      eat_cursor_(eat_dist_.startCursor(id, num_philosophers))
 {
 }
 
@@ -26,17 +65,42 @@ Philosopher::~Philosopher()
 void Philosopher::start()
 {
     running_ = true;
+    cancel_token_.reset();
     thread_ = std::thread(&Philosopher::run, this);  // 启动线程
 }
 
 void Philosopher::stop()
 {
-    running_ = false;  // 设置停止标志
+    requestStop();
+    join();
+}
+
+void Philosopher::requestStop()
+{
+    {
+        // 持锁修改标志，保证睡眠中的线程不会错过这次唤醒
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        running_ = false;  // 设置停止标志
+    }
+    cancel_token_.cancel();  // 打断正在进行的筷子等待
+    sleep_cv_.notify_all();  // 打断思考/进餐中的睡眠
+}
+
+void Philosopher::join()
+{
     if (thread_.joinable()) {
         thread_.join();  // 等待线程结束
     }
 }
 
+bool Philosopher::sleepFor(std::chrono::milliseconds duration)
+{
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    return !sleep_cv_.wait_for(lock, duration, [this] {
+        return !running_.load(std::memory_order_acquire);
+    });
+}
+
 PhilosopherState Philosopher::getState() const
 {
     return state_.load(std::memory_order_acquire);  // 原子读取状态
@@ -47,64 +111,223 @@ int Philosopher::getEatCount() const
     return eat_count_.load(std::memory_order_acquire);  // 原子读取进餐次数
 }
 
+void Philosopher::setState(PhilosopherState state)
+{
+    PhilosopherState previous = state_.exchange(state, std::memory_order_acq_rel);
+    // 只在进出饥饿状态时取时间，其余转换没有额外开销
+    if (state == PhilosopherState::HUNGRY && previous != PhilosopherState::HUNGRY) {
+        hungry_since_ns_.store(steadyNanos(), std::memory_order_release);
+    } else if (previous == PhilosopherState::HUNGRY && state != PhilosopherState::HUNGRY) {
+        // 先清开始时刻再累加：读者看到新的累计值时一定也看到开始时刻已变，不会把这一段算两次
+        std::int64_t since = hungry_since_ns_.exchange(0, std::memory_order_acq_rel);
+        hungry_total_ns_.fetch_add(steadyNanos() - since, std::memory_order_release);
+    }
+    manager_.markChanged(id_);
+}
+
+std::chrono::nanoseconds Philosopher::getHungryTime() const
+{
+    // 读累计值前后开始时刻不变才算一致；两次写之间读到的值可能暂时偏小，但不会重复计入
+    std::int64_t since = hungry_since_ns_.load(std::memory_order_acquire);
+    std::int64_t total = 0;
+    while (true) {
+        total = hungry_total_ns_.load(std::memory_order_acquire);
+        std::int64_t check = hungry_since_ns_.load(std::memory_order_acquire);
+        if (check == since)
+            break;
+        since = check;
+    }
+    if (since != 0)
+        total += std::max<std::int64_t>(0, steadyNanos() - since);
+    return std::chrono::nanoseconds(total);
+}
+
 int Philosopher::getId() const
 {
     return id_;
 }
 
+void Philosopher::setHungryTimeout(std::chrono::milliseconds timeout)
+{
+    hungry_timeout_ = timeout;
+}
+
+void Philosopher::setCpu(int cpu)
+{
+    cpu_ = cpu;
+}
+
+void Philosopher::setVacant(bool vacant)
+{
+    vacant_.store(vacant, std::memory_order_relaxed);
+}
+
+bool Philosopher::isVacant() const
+{
+    return vacant_.load(std::memory_order_relaxed);
+}
+
 void Philosopher::eat()
 {
-    state_ = PhilosopherState::EATING;  // 设置进餐状态
-    int eat_time = eat_dist_(gen_);     // 生成随机进餐时间
-    std::this_thread::sleep_for(std::chrono::milliseconds(eat_time));  // 模拟进餐
-    eat_count_.fetch_add(1, std::memory_order_release);                // 原子增加进餐计数
-    state_ = PhilosopherState::THINKING;  // 进餐结束，回到思考等待下一轮
+    setState(PhilosopherState::EATING);  // 设置进餐状态
+    int eat_time = eat_dist_(gen_, eat_cursor_);     // 生成随机进餐时间
+    if (sleepFor(std::chrono::milliseconds(eat_time))) {  // 模拟进餐，停止时提前结束
+        eat_count_.fetch_add(1, std::memory_order_release);  // 原子增加进餐计数
+        manager_.notifyMealFinished(id_);
+    }
+    setState(PhilosopherState::THINKING);  // 进餐结束，回到思考等待下一轮
 }
 
 void Philosopher::run()
 {
+    if (cpu_ >= 0) {
+        pinCurrentThread(cpu_);
+        manager_.placeChopstick(id_);
+    }
+
     while (running_.load(std::memory_order_acquire)) {
         think();  // 思考阶段
 
         if (!running_.load(std::memory_order_acquire))
             break;
-
-        state_ = PhilosopherState::HUNGRY;
-
-        auto guard = manager_.acquireChopsticks(id_);
+        if (isVacant())
+            continue;  // 空座不争筷子
+
+        setState(PhilosopherState::HUNGRY);
+
+        auto deadline = hungry_timeout_.count() > 0
+                            ? std::chrono::steady_clock::now() + hungry_timeout_
+                            : std::chrono::steady_clock::time_point::max();
+        // 排队锁不能中途放弃，只能阻塞等到轮到自己；停止时持有者进餐会提前结束，队伍照样走完
+        auto guard = manager_.canAbandonWait()
+                         ? manager_.tryAcquireChopsticks(id_, deadline, &cancel_token_)
+                         : std::optional<PhilosopherManager::ChopstickGuard>(manager_.acquireChopsticks(id_));
+        if (!guard)
+            continue;  // 超时放弃本轮或被取消，回到思考（取消时循环条件会退出）
         eat();
     }
 }
 
 void Philosopher::think()
 {
-    state_ = PhilosopherState::THINKING;  // 设置思考状态
-    int think_time = think_dist_(gen_);   // 生成随机思考时间
-    std::this_thread::sleep_for(std::chrono::milliseconds(think_time));  // 模拟思考
+    setState(PhilosopherState::THINKING);  // 设置思考状态
+    int think_time = think_dist_(gen_, think_cursor_);   // 生成随机思考时间
+    sleepFor(std::chrono::milliseconds(think_time));  // 模拟思考，停止时提前结束
 }
 
-// PhilosopherManager 实现
-PhilosopherManager::PhilosopherManager(int num_philosophers)
-    : num_philosophers_(num_philosophers),
-      chopstick_owner_(num_philosophers_)
+CoroTask Philosopher::runCoroutine(CoroScheduler& scheduler)
 {
-    // 使用 reserve 预分配空间，避免重新分配
-    chopsticks_.reserve(num_philosophers_);
-    for (int i = 0; i < num_philosophers_; ++i) {
-        chopsticks_.push_back(std::make_unique<std::mutex>());
+    std::span<const int> chopsticks = manager_.chopsticksFor(id_);
+
+    // 与 run() 相同的状态循环，只是每个阻塞点都换成挂起；停止时协程帧由调度器直接销毁
+    while (true) {
+        setState(PhilosopherState::THINKING);
+        co_await scheduler.sleepFor(std::chrono::milliseconds(think_dist_(gen_, think_cursor_)));
+        if (isVacant())
+            continue;
+
+        setState(PhilosopherState::HUNGRY);
+        co_await scheduler.acquireChopsticks(id_, chopsticks);
+
+        setState(PhilosopherState::EATING);
+        co_await scheduler.sleepFor(std::chrono::milliseconds(eat_dist_(gen_, eat_cursor_)));
+        eat_count_.fetch_add(1, std::memory_order_release);
+        scheduler.releaseChopsticks(chopsticks);
+        manager_.notifyMealFinished(id_);
     }
+}
+
+void Philosopher::beginPooled(WorkStealingPool& pool)
+{
+    setState(PhilosopherState::THINKING);
+    pool.scheduleAfter(id_, std::chrono::milliseconds(think_dist_(gen_, think_cursor_)));
+}
+
+void Philosopher::runPooledStep(WorkStealingPool& pool)
+{
+    // 同一座位同一时刻只会在一个工作线程上执行，gen_ 无需额外同步
+    std::span<const int> chopsticks = manager_.chopsticksFor(id_);
+
+    switch (state_.load(std::memory_order_acquire)) {
+    case PhilosopherState::THINKING:  // 思考结束
+        if (isVacant()) {
+            pool.scheduleAfter(id_, std::chrono::milliseconds(think_dist_(gen_, think_cursor_)));
+            return;
+        }
+        setState(PhilosopherState::HUNGRY);
+        [[fallthrough]];
+    case PhilosopherState::HUNGRY:    // 首次尝试或被放筷子的邻居唤醒后重试
+        if (!pool.tryAcquireOrPark(id_, chopsticks))
+            return;
+        setState(PhilosopherState::EATING);
+        pool.scheduleAfter(id_, std::chrono::milliseconds(eat_dist_(gen_, eat_cursor_)));
+        return;
+    case PhilosopherState::EATING:    // 进餐结束
+        eat_count_.fetch_add(1, std::memory_order_release);
+        pool.releaseChopsticks(chopsticks);  // 先放筷子再改状态，渲染线程看到新版本号时持有表已更新
+        setState(PhilosopherState::THINKING);
+        manager_.notifyMealFinished(id_);
+        pool.scheduleAfter(id_, std::chrono::milliseconds(think_dist_(gen_, think_cursor_)));
+        return;
+    }
+}
 
-    sem_init(&waiter_, 0, num_philosophers_ - 1);  // 服务员算法，允许 n-1 个哲学家同时拿筷子
+// PhilosopherManager 实现
+PhilosopherManager::PhilosopherManager(int num_philosophers, const SimulationOptions& options)
+    : topology_(options.topology ? options.topology
+                                 : std::make_shared<const ResourceTopology>(ResourceTopology::ring(num_philosophers))),
+      num_philosophers_(topology_->numSeats()),
+      wait_stats_(num_philosophers_),
+      chopstick_owner_(topology_->numResources()),
+      changed_seats_(options.track_changes ? (num_philosophers_ + 63) / 64 : 0),
+      options_(options),
+      chopstick_traffic_(options.track_traffic ? topology_->numResources() : 0),
+      placement_pending_(0)
+{
+    std::span<const int> lastSeat = topology_->resourcesOf(num_philosophers_ - 1);
+    chopsticks_ = std::make_unique<ChopstickLocks>(options_.chopstick_lock, topology_->numResources(),
+                                                   slotOf(lastSeat, lastSeat.size()));
+
+    // 服务员算法，默认允许 n-1 个哲学家同时拿筷子
+    int waiters = options_.waiter_capacity > 0 ? std::min(options_.waiter_capacity, num_philosophers_ - 1)
+                                               : num_philosophers_ - 1;
+    sem_init(&waiter_, 0, waiters);
+
+    // 缩放只做一次，所有哲学家共享同一份分位点表
+    options_.think_duration = options_.think_duration.scaled(options_.time_scale);
+    options_.eat_duration = options_.eat_duration.scaled(options_.time_scale);
+    options_.time_scale = 1.0;
+
+    if (options_.seed == 0) {
+        std::random_device rd;
+        options_.seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }
+    if (options_.arbitration != ArbitrationPolicy::SEMAPHORE) {
+        arbiter_ = std::make_unique<AdmissionArbiter>(options_.arbitration, num_philosophers_,
+                                                      waiters, options_.seat_weights,
+                                                      mixSeed(options_.seed));
+    }
 
     // 创建哲学家对象
     philosophers_.reserve(num_philosophers_);
     for (int i = 0; i < num_philosophers_; ++i) {
-        philosophers_.push_back(std::make_unique<Philosopher>(i, num_philosophers_, *this));
+        philosophers_.push_back(std::make_unique<Philosopher>(i, num_philosophers_, *this, options_));
+    }
+
+    if (options_.pin_threads) {
+        std::vector<int> seatCpus = assignSeatCpus(detectCpuTopology(), num_philosophers_);
+        for (int i = 0; i < num_philosophers_; ++i) {
+            philosophers_[i]->setCpu(seatCpus[i]);
+        }
     }
 
     for (auto& owner : chopstick_owner_) {
         owner.store(-1, std::memory_order_relaxed);
     }
+    // 读者第一次取变化时拿到全部座位，据此画出初始状态
+    for (int i = 0; i < num_philosophers_; ++i) {
+        markChanged(i);
+    }
 }
 
 PhilosopherManager::~PhilosopherManager()
@@ -115,6 +338,48 @@ PhilosopherManager::~PhilosopherManager()
 
 void PhilosopherManager::start()
 {
+    if (options_.mode == ExecutionMode::COROUTINE) {
+        coroutine_timers_ = std::make_unique<CoroScheduler::TimerQueue>();
+        scheduler_ = std::make_unique<CoroScheduler>(chopstick_owner_, *coroutine_timers_);
+        for (auto& philosopher : philosophers_) {
+            scheduler_->spawn(philosopher->runCoroutine(*scheduler_));
+        }
+        scheduler_thread_ = std::thread([this] {
+            if (options_.scheduler_cpu >= 0) {
+                pinCurrentThread(options_.scheduler_cpu);
+            } else if (options_.pin_threads) {
+                std::vector<int> seatCpus = assignSeatCpus(detectCpuTopology(), 1);
+                pinCurrentThread(seatCpus[0]);
+            }
+            scheduler_->run();
+        });
+        return;
+    }
+
+    if (options_.mode == ExecutionMode::POOLED) {
+        int workers = options_.pool_workers > 0
+                          ? options_.pool_workers
+                          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        int seats = static_cast<int>(philosophers_.size());
+        pool_ = std::make_unique<WorkStealingPool>(workers, seats, chopstick_owner_, [this](int seat) {
+            philosophers_[seat]->runPooledStep(*pool_);
+        });
+        // 主线程按轮转把座位分给各工作线程；之后的唤醒都留在放筷子的线程上
+        for (auto& philosopher : philosophers_) {
+            philosopher->beginPooled(*pool_);
+        }
+        std::vector<int> workerCpus;
+        if (options_.pin_threads) {
+            workerCpus = assignSeatCpus(detectCpuTopology(), workers);
+        }
+        pool_->start(workerCpus);
+        return;
+    }
+
+    if (options_.pin_threads) {
+        std::lock_guard<std::mutex> lock(placement_mutex_);
+        placement_pending_ = num_philosophers_;
+    }
     for (auto& philosopher : philosophers_) {
         philosopher->start();
     }
@@ -123,8 +388,25 @@ void PhilosopherManager::start()
 
 void PhilosopherManager::stop()
 {
+    if (scheduler_) {
+        scheduler_->requestStop();
+        if (scheduler_thread_.joinable()) {
+            scheduler_thread_.join();
+        }
+        scheduler_.reset();  // 销毁所有挂起的协程帧
+    }
+
+    if (pool_) {
+        pool_->stop();
+        pool_.reset();
+    }
+
+    // 先向所有哲学家广播停止，再逐个 join，总耗时只取决于一次唤醒延迟
+    for (auto& philosopher : philosophers_) {
+        philosopher->requestStop();
+    }
     for (auto& philosopher : philosophers_) {
-        philosopher->stop();
+        philosopher->join();
     }
 
     for (auto& owner : chopstick_owner_) {
@@ -153,34 +435,254 @@ int PhilosopherManager::getNumPhilosophers() const
     return num_philosophers_;  // 返回哲学家数量
 }
 
+int PhilosopherManager::getNumChopsticks() const
+{
+    return topology_->numResources();
+}
+
+const ResourceTopology& PhilosopherManager::getTopology() const
+{
+    return *topology_;
+}
+
 int PhilosopherManager::getChopstickOwner(int idx) const
 {
-    if (idx >= 0 && idx < num_philosophers_) {
+    if (idx >= 0 && idx < getNumChopsticks()) {
         return chopstick_owner_[idx].load(std::memory_order_acquire);
     }
     return -1;
 }
 
+void PhilosopherManager::setHungryTimeout(std::chrono::milliseconds timeout)
+{
+    if (timeout.count() > 0 && !canAbandonWait()) {
+        std::cerr << "Hungry timeouts need the mutex chopstick locks, not '"
+                  << chopstickLockKindName(chopsticks_->kind()) << "'" << std::endl;
+        return;
+    }
+    for (auto& philosopher : philosophers_) {
+        philosopher->setHungryTimeout(timeout);
+    }
+}
+
+void PhilosopherManager::markChanged(int id)
+{
+    if (changed_seats_.empty())
+        return;
+    std::atomic<std::uint64_t>& word = changed_seats_[id / 64].bits;
+    std::uint64_t bit = std::uint64_t{1} << (id % 64);
+    if ((word.load(std::memory_order_relaxed) & bit) == 0)
+        word.fetch_or(bit, std::memory_order_release);
+}
+
+void PhilosopherManager::takeChangedSeats(std::vector<int>& out)
+{
+    // 先清标记再由调用方读状态：清除之后的变化会重新置位，下次再取，不会漏
+    for (std::size_t w = 0; w < changed_seats_.size(); ++w) {
+        if (changed_seats_[w].bits.load(std::memory_order_relaxed) == 0)
+            continue;
+        std::uint64_t bits = changed_seats_[w].bits.exchange(0, std::memory_order_acquire);
+        while (bits != 0) {
+            out.push_back(static_cast<int>(w * 64) + std::countr_zero(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+void PhilosopherManager::notifyMealFinished(int id)
+{
+    if (options_.on_meal) {
+        options_.on_meal(id);
+    }
+}
+
+void PhilosopherManager::setSeatVacant(int id, bool vacant)
+{
+    if (id >= 0 && id < num_philosophers_) {
+        philosophers_[id]->setVacant(vacant);
+    }
+}
+
+bool PhilosopherManager::isSeatVacant(int id) const
+{
+    return id >= 0 && id < num_philosophers_ && philosophers_[id]->isVacant();
+}
+
+ChopstickTrafficStats PhilosopherManager::getTrafficStats() const
+{
+    ChopstickTrafficStats stats;
+    for (const auto& traffic : chopstick_traffic_) {
+        stats.acquisitions += traffic.acquisitions.load(std::memory_order_relaxed);
+        stats.cross_node += traffic.cross_node.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+std::chrono::nanoseconds PhilosopherManager::getHungryTime(int id) const
+{
+    if (id >= 0 && id < num_philosophers_) {
+        return philosophers_[id]->getHungryTime();
+    }
+    return std::chrono::nanoseconds(0);
+}
+
+const WaitRecorder& PhilosopherManager::getWaitStats() const
+{
+    return wait_stats_;
+}
+
+void PhilosopherManager::placeChopstick(int id)
+{
+    // 依赖首次触碰策略：由绑核后的线程分配并初始化，内存页落在该线程所在节点
+    for (int chopstick : topology_->resourcesOf(id)) {
+        if (topology_->usersOf(chopstick).front() == id) {
+            chopsticks_->place(chopstick);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(placement_mutex_);
+    if (--placement_pending_ == 0) {
+        placement_cv_.notify_all();
+    } else {
+        placement_cv_.wait(lock, [this] { return placement_pending_ == 0; });
+    }
+}
+
+void PhilosopherManager::recordAcquisition(std::span<const int> chopsticks)
+{
+    if (chopstick_traffic_.empty())
+        return;  // 未开启统计，热路径上不查询 CPU 也不写计数
+    int node = currentNumaNode();
+    if (node < 0)
+        return;
+
+    for (int idx : chopsticks) {
+        ChopstickTraffic& traffic = chopstick_traffic_[idx];
+        int previous = traffic.last_node.exchange(node, std::memory_order_relaxed);
+        if (previous < 0)
+            continue;
+        traffic.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (previous != node)
+            traffic.cross_node.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool PhilosopherManager::canAbandonWait() const
+{
+    return chopsticks_->abandonable();
+}
+
+std::span<const int> PhilosopherManager::chopsticksFor(int id) const
+{
+    return topology_->resourcesOf(id);
+}
+
+std::size_t PhilosopherManager::slotOf(std::span<const int> chopsticks, std::size_t i) const
+{
+    return static_cast<std::size_t>(chopsticks.data() - topology_->resourcesOf(0).data()) + i;
+}
+
 PhilosopherManager::ChopstickGuard PhilosopherManager::acquireChopsticks(int id)
 {
-    int left = (id + num_philosophers_ - 1) % num_philosophers_;
-    int right = id;
+    return std::move(*tryAcquireChopsticks(id, std::chrono::steady_clock::time_point::max()));
+}
 
-    sem_wait(&waiter_);
+bool PhilosopherManager::waitForWaiter(int id, std::chrono::steady_clock::time_point deadline,
+                                       const CancellationToken* token)
+{
+    if (arbiter_) {
+        arbiter_->enqueue(id);
+        while (!arbiter_->waitUntil(id, nextSliceEnd(deadline))) {
+            if (shouldGiveUp(deadline, token) && arbiter_->withdraw(id))
+                return false;
+        }
+        return true;
+    }
 
-    std::unique_lock<std::mutex> left_lock(*chopsticks_[left], std::defer_lock);
-    std::unique_lock<std::mutex> right_lock(*chopsticks_[right], std::defer_lock);
-    std::lock(left_lock, right_lock);
+    while (sem_trywait(&waiter_) != 0) {
+        if (shouldGiveUp(deadline, token))
+            return false;
+
+        // sem_timedwait 只接受 CLOCK_REALTIME 绝对时间，这里只用它等待一个切片
+        auto slice = nextSliceEnd(deadline) - std::chrono::steady_clock::now();
+        auto slice_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(slice).count();
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += std::max<long long>(slice_ns, 0);
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        if (sem_timedwait(&waiter_, &ts) == 0)
+            return true;
+        // ETIMEDOUT / EINTR：回到循环重新检查
+    }
+    return true;
+}
 
-    chopstick_owner_[left].store(id, std::memory_order_release);
-    chopstick_owner_[right].store(id, std::memory_order_release);
+void PhilosopherManager::leaveWaiter(int id)
+{
+    if (arbiter_)
+        arbiter_->release(id);
+    else
+        sem_post(&waiter_);
+}
+
+std::optional<PhilosopherManager::ChopstickGuard> PhilosopherManager::tryAcquireChopsticks(
+    int id, std::chrono::steady_clock::time_point deadline, const CancellationToken* token)
+{
+    // 所有哲学家都按筷子编号升序加锁，等待关系不会成环，环形桌与一般冲突图走同一路径
+    std::span<const int> chopsticks = chopsticksFor(id);
+    const bool unbounded = !token && deadline == std::chrono::steady_clock::time_point::max();
+    if (!unbounded && !chopsticks_->abandonable()) {
+        std::cerr << "Chopstick locks '" << chopstickLockKindName(chopsticks_->kind())
+                  << "' cannot abandon a queued wait; use acquireChopsticks or the mutex locks" << std::endl;
+        return std::nullopt;
+    }
+    auto hungrySince = std::chrono::steady_clock::now();
+
+    if (unbounded) {
+        // 无截止时间也无令牌时保持阻塞路径，避免无谓的分片唤醒
+        if (arbiter_) {
+            arbiter_->enqueue(id);
+            arbiter_->wait(id);
+        } else {
+            sem_wait(&waiter_);
+        }
+        for (std::size_t i = 0; i < chopsticks.size(); ++i) {
+            chopsticks_->lock(chopsticks[i], slotOf(chopsticks, i));
+        }
+    } else {
+        if (!waitForWaiter(id, deadline, token))
+            return std::nullopt;
+
+        std::size_t locked = 0;
+        while (locked < chopsticks.size()) {
+            if (shouldGiveUp(deadline, token)) {
+                for (std::size_t i = 0; i < locked; ++i) {
+                    chopsticks_->unlock(chopsticks[i], slotOf(chopsticks, i));
+                }
+                leaveWaiter(id);
+                return std::nullopt;
+            }
+            if (chopsticks_->tryLockUntil(chopsticks[locked], nextSliceEnd(deadline)))
+                ++locked;
+        }
+    }
 
-    return ChopstickGuard(std::move(left_lock), std::move(right_lock), this, id, left, right);
+    for (int chopstick : chopsticks) {
+        chopstick_owner_[chopstick].store(id, std::memory_order_release);
+    }
+    recordAcquisition(chopsticks);
+    wait_stats_.record(id, std::chrono::steady_clock::now() - hungrySince);
+
+    return ChopstickGuard(this, id, chopsticks);
 }
 
-void PhilosopherManager::releaseChopsticksInternal(int owner, int left, int right)
+void PhilosopherManager::releaseChopsticksInternal(int owner, std::span<const int> chopsticks)
 {
-    chopstick_owner_[left].store(-1, std::memory_order_release);
-    chopstick_owner_[right].store(-1, std::memory_order_release);
-    sem_post(&waiter_);
-}
\ No newline at end of file
+    for (std::size_t i = 0; i < chopsticks.size(); ++i) {
+        chopstick_owner_[chopsticks[i]].store(-1, std::memory_order_release);
+        chopsticks_->unlock(chopsticks[i], slotOf(chopsticks, i));
+    }
+    markChanged(owner);
+    leaveWaiter(owner);
+}
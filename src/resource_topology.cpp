@@ -0,0 +1,199 @@
+#include "resource_topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+namespace {
+
+constexpr int kAttempts = 100;  // 随机正则图的整体重试次数
+
+}  // namespace
+
+ResourceTopology ResourceTopology::fromEdges(int seats, const std::vector<std::pair<int, int>>& edges,
+                                             std::string name)
+{
+    ResourceTopology topology;
+    topology.name_ = std::move(name);
+
+    std::vector<int> degree(seats, 0);
+    for (const auto& [u, v] : edges) {
+        ++degree[u];
+        ++degree[v];
+    }
+
+    topology.seat_offsets_.assign(seats + 1, 0);
+    for (int seat = 0; seat < seats; ++seat) {
+        topology.seat_offsets_[seat + 1] = topology.seat_offsets_[seat] + degree[seat];
+        topology.max_degree_ = std::max(topology.max_degree_, degree[seat]);
+    }
+
+    // 资源按边的顺序编号，依次追加到两个端点，因此每个座位的资源天然升序
+    topology.seat_resources_.resize(topology.seat_offsets_[seats]);
+    std::vector<int> cursor(topology.seat_offsets_.begin(), topology.seat_offsets_.end() - 1);
+    topology.resource_offsets_.reserve(edges.size() + 1);
+    topology.resource_offsets_.push_back(0);
+    topology.resource_users_.reserve(edges.size() * 2);
+    for (std::size_t resource = 0; resource < edges.size(); ++resource) {
+        auto [u, v] = edges[resource];
+        topology.seat_resources_[cursor[u]++] = static_cast<int>(resource);
+        topology.seat_resources_[cursor[v]++] = static_cast<int>(resource);
+        topology.resource_users_.push_back(u);
+        topology.resource_users_.push_back(v);
+        topology.resource_offsets_.push_back(static_cast<int>(topology.resource_users_.size()));
+    }
+    return topology;
+}
+
+ResourceTopology ResourceTopology::ring(int seats)
+{
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(seats);
+    for (int seat = 0; seat < seats; ++seat) {
+        edges.emplace_back(seat, (seat + 1) % seats);
+    }
+    return fromEdges(seats, edges, "ring:" + std::to_string(seats));
+}
+
+ResourceTopology ResourceTopology::torus(int rows, int cols)
+{
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(static_cast<std::size_t>(rows) * cols * 2);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int seat = r * cols + c;
+            int rightSeat = r * cols + (c + 1) % cols;
+            int downSeat = ((r + 1) % rows) * cols + c;
+            // 只有 2 列（行）时回绕的边与正向的边连着同一对座位，不再重复添加；只有 1 列（行）时没有这条边
+            if (c + 1 < cols || cols > 2)
+                edges.emplace_back(seat, rightSeat);
+            if (r + 1 < rows || rows > 2)
+                edges.emplace_back(seat, downSeat);
+        }
+    }
+    return fromEdges(rows * cols, edges, "torus:" + std::to_string(rows) + "x" + std::to_string(cols));
+}
+
+std::optional<ResourceTopology> ResourceTopology::randomRegular(int seats, int degree, std::uint64_t seed)
+{
+    if (seats < 2 || degree < 1 || degree >= seats || (static_cast<long long>(seats) * degree) % 2 != 0) {
+        std::cerr << "No " << degree << "-regular graph on " << seats
+                  << " seats: need 1 <= degree < seats and seats * degree even" << std::endl;
+        return std::nullopt;
+    }
+
+    // 配对模型：每个座位 degree 个端口随机两两配对，出现自环或重边时整体重试
+    std::mt19937_64 gen(seed);
+    std::vector<int> stubs;
+    std::vector<std::pair<int, int>> edges;
+    for (int attempt = 0; attempt < kAttempts; ++attempt) {
+        stubs.clear();
+        for (int seat = 0; seat < seats; ++seat) {
+            stubs.insert(stubs.end(), degree, seat);
+        }
+        std::shuffle(stubs.begin(), stubs.end(), gen);
+
+        edges.clear();
+        std::set<std::pair<int, int>> seen;
+        bool simple = true;
+        for (std::size_t i = 0; i + 1 < stubs.size(); i += 2) {
+            int u = std::min(stubs[i], stubs[i + 1]);
+            int v = std::max(stubs[i], stubs[i + 1]);
+            if (u == v || !seen.insert({u, v}).second) {
+                simple = false;
+                break;
+            }
+            edges.emplace_back(u, v);
+        }
+        if (simple)
+            return fromEdges(seats, edges, "regular:" + std::to_string(seats) + ":" + std::to_string(degree));
+    }
+    // 度数接近座位数时配对模型几乎总会产生重边，宁可报错也不返回度数不齐的图
+    std::cerr << "Failed to build a " << degree << "-regular graph on " << seats << " seats after " << kAttempts
+              << " attempts; try a smaller degree or another seed" << std::endl;
+    return std::nullopt;
+}
+
+std::optional<ResourceTopology> ResourceTopology::fromEdgeList(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open edge list: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<int, int>> edges;
+    int seats = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        int u = 0;
+        int v = 0;
+        if (!(fields >> u >> v) || u < 0 || v < 0) {
+            std::cerr << "Bad edge in " << path << ": " << line << std::endl;
+            return std::nullopt;
+        }
+        if (u == v)
+            continue;  // 自环不构成争用
+        edges.emplace_back(u, v);
+        seats = std::max(seats, std::max(u, v) + 1);
+    }
+    if (seats < 2) {
+        std::cerr << "Edge list has fewer than two seats: " << path << std::endl;
+        return std::nullopt;
+    }
+    return fromEdges(seats, edges, "file:" + path);
+}
+
+std::optional<ResourceTopology> ResourceTopology::parse(const std::string& spec, int default_seats)
+{
+    std::string kind = spec.substr(0, spec.find(':'));
+    std::string rest = spec.find(':') == std::string::npos ? "" : spec.substr(spec.find(':') + 1);
+
+    if (kind == "ring") {
+        int seats = rest.empty() ? default_seats : std::atoi(rest.c_str());
+        if (seats >= 2)
+            return ring(seats);
+    } else if (kind == "torus") {
+        int rows = 0;
+        int cols = 0;
+        char x = 0;
+        std::istringstream fields(rest);
+        if (fields >> rows >> x >> cols && x == 'x' && rows >= 1 && cols >= 1 && rows * cols >= 2)
+            return torus(rows, cols);
+    } else if (kind == "regular") {
+        // regular:N:K[:seed]
+        int seats = 0;
+        int degree = 0;
+        unsigned long long seed = 1;
+        char sep = 0;
+        std::istringstream fields(rest);
+        if (fields >> seats >> sep >> degree) {
+            fields >> sep >> seed;
+            return randomRegular(seats, degree, seed);
+        }
+    } else if (kind == "file") {
+        return fromEdgeList(rest);
+    }
+
+    std::cerr << "Bad topology: " << spec << std::endl;
+    return std::nullopt;
+}
+
+std::span<const int> ResourceTopology::resourcesOf(int seat) const
+{
+    return std::span<const int>(seat_resources_.data() + seat_offsets_[seat],
+                                seat_offsets_[seat + 1] - seat_offsets_[seat]);
+}
+
+std::span<const int> ResourceTopology::usersOf(int resource) const
+{
+    return std::span<const int>(resource_users_.data() + resource_offsets_[resource],
+                                resource_offsets_[resource + 1] - resource_offsets_[resource]);
+}
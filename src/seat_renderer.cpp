@@ -0,0 +1,174 @@
+#include "seat_renderer.h"
+#include "Shader_m.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+enum Pass { PORTRAIT = 0, ICON = 1, POINT = 2, RING = 3 };
+
+constexpr float kFullDetailPixels = 12.0f;  // 头像直径不足这么多像素时改画点
+constexpr float kPointPixels = 1.5f;        // 座位间距不足这么多像素时改画圆环
+constexpr float kMinRingPixels = 4.0f;      // 圆环的最小屏幕宽度
+
+}  // namespace
+
+SeatRenderer::SeatRenderer(const std::string& vertex_path, const std::string& fragment_path,
+                           std::span<const glm::vec2> seats, float seat_radius, glm::vec2 icon_half_size,
+                           float icon_offset, GLuint portrait, const std::array<GLuint, 3>& icons)
+    : portrait_(portrait),
+      icons_(icons),
+      seat_radius_(seat_radius),
+      ring_radius_(0.0f),
+      seat_spacing_(0.0f),
+      states_(seats.size(), static_cast<std::uint8_t>(PhilosopherState::THINKING))
+{
+    Shader shader(vertex_path.c_str(), fragment_path.c_str());
+    program_ = shader.ID;
+    projection_location_ = glGetUniformLocation(program_, "projection");
+    pass_location_ = glGetUniformLocation(program_, "pass");
+    glUseProgram(program_);
+    glUniform1f(glGetUniformLocation(program_, "seatRadius"), seat_radius);
+    glUniform2f(glGetUniformLocation(program_, "iconHalfSize"), icon_half_size.x, icon_half_size.y);
+    glUniform1f(glGetUniformLocation(program_, "iconOffset"), icon_offset);
+    glUniform1i(glGetUniformLocation(program_, "portraitSampler"), 0);
+    glUniform1i(glGetUniformLocation(program_, "thinkingSampler"), 1);
+    glUniform1i(glGetUniformLocation(program_, "hungrySampler"), 2);
+    glUniform1i(glGetUniformLocation(program_, "eatingSampler"), 3);
+    glUniform1i(glGetUniformLocation(program_, "stateBuffer"), 4);
+
+    for (const glm::vec2& seat : seats) {
+        ring_radius_ += glm::length(seat);
+    }
+    if (!seats.empty())
+        ring_radius_ /= static_cast<float>(seats.size());
+    seat_spacing_ = seats.size() > 1 ? 2.0f * static_cast<float>(M_PI) * ring_radius_ / seats.size()
+                                     : 2.0f * seat_radius_;
+    glUniform1f(glGetUniformLocation(program_, "ringRadius"), ring_radius_);
+    glUniform1i(glGetUniformLocation(program_, "seatCount"), static_cast<GLint>(seats.size()));
+
+    glGenVertexArrays(1, &vao_);
+    glBindVertexArray(vao_);
+
+    const float corners[8] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glGenBuffers(1, &quad_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &seat_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, seat_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(seats.size() * sizeof(glm::vec2)), seats.data(),
+                 GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glGenBuffers(1, &state_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, state_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(states_.size()), states_.data(), GL_DYNAMIC_DRAW);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_BYTE, 1, (void*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+
+    glGenTextures(1, &state_texture_);
+    glBindTexture(GL_TEXTURE_BUFFER, state_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, state_vbo_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+SeatRenderer::~SeatRenderer()
+{
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &quad_vbo_);
+    glDeleteBuffers(1, &seat_vbo_);
+    glDeleteTextures(1, &state_texture_);
+    glDeleteBuffers(1, &state_vbo_);
+    glDeleteProgram(program_);
+}
+
+void SeatRenderer::setState(int seat, PhilosopherState state)
+{
+    auto value = static_cast<std::uint8_t>(state);
+    if (states_[seat] == value)
+        return;
+    states_[seat] = value;
+    if (dirty_begin_ == dirty_end_) {
+        dirty_begin_ = seat;
+        dirty_end_ = seat + 1;
+    } else {
+        dirty_begin_ = std::min(dirty_begin_, seat);
+        dirty_end_ = std::max(dirty_end_, seat + 1);
+    }
+}
+
+SeatLod SeatRenderer::lodFor(float pixels_per_unit) const
+{
+    if (2.0f * seat_radius_ * pixels_per_unit >= kFullDetailPixels)
+        return SeatLod::FULL;
+    if (seat_spacing_ * pixels_per_unit >= kPointPixels)
+        return SeatLod::POINTS;
+    return SeatLod::RING;
+}
+
+void SeatRenderer::draw(const glm::mat4& projection, float pixels_per_unit)
+{
+    glBindVertexArray(vao_);
+    if (dirty_begin_ != dirty_end_) {
+        glBindBuffer(GL_ARRAY_BUFFER, state_vbo_);
+        glBufferSubData(GL_ARRAY_BUFFER, dirty_begin_, dirty_end_ - dirty_begin_, states_.data() + dirty_begin_);
+        dirty_begin_ = dirty_end_ = 0;
+    }
+
+    glUseProgram(program_);
+    glUniformMatrix4fv(projection_location_, 1, GL_FALSE, glm::value_ptr(projection));
+    auto count = static_cast<GLsizei>(states_.size());
+
+    switch (lodFor(pixels_per_unit)) {
+    case SeatLod::FULL:
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, portrait_);
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE1 + i);
+            glBindTexture(GL_TEXTURE_2D, icons_[i]);
+        }
+        // 头像全部画完再画图标，图标总在头像上层
+        glUniform1i(pass_location_, PORTRAIT);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glUniform1i(pass_location_, ICON);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        for (int i = 3; i >= 0; --i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        break;
+    case SeatLod::POINTS: {
+        // 点的直径取座位间距，但不超过完整头像
+        float size = std::clamp(seat_spacing_ * pixels_per_unit, 1.0f, 2.0f * seat_radius_ * pixels_per_unit);
+        glUniform1f(glGetUniformLocation(program_, "pointSize"), size);
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        glUniform1i(pass_location_, POINT);
+        glDrawArraysInstanced(GL_POINTS, 0, 1, count);
+        glDisable(GL_PROGRAM_POINT_SIZE);
+        break;
+    }
+    case SeatLod::RING:
+        // 单个四边形覆盖整个圆环，片元着色器按角度换算座位编号后查状态
+        glUniform1f(glGetUniformLocation(program_, "ringWidth"),
+                    std::max(seat_radius_, 0.5f * kMinRingPixels / pixels_per_unit));
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_BUFFER, state_texture_);
+        glUniform1i(pass_location_, RING);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+        break;
+    }
+    glBindVertexArray(0);
+}
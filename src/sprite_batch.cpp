@@ -0,0 +1,245 @@
+#include "sprite_batch.h"
+#include "Shader_m.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+std::uint8_t toByte(float value)
+{
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// 当前上下文是否支持持久映射（GL 4.4 或 ARB_buffer_storage，且函数指针已加载）
+bool supportsBufferStorage()
+{
+    if (!glBufferStorage)
+        return false;
+    if (GLAD_GL_VERSION_4_4)
+        return true;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+SpriteBatch::SpriteBatch(const std::string& vertex_path, const std::string& fragment_path,
+                         std::size_t initial_sprites)
+{
+    Shader shader(vertex_path.c_str(), fragment_path.c_str());
+    program_ = shader.ID;
+    projection_location_ = glGetUniformLocation(program_, "projection");
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "texSampler"), 0);
+
+    // 纯色精灵也走纹理路径，乘上 1x1 白色纹理，不必因为“有无纹理”拆批
+    const std::uint8_t white[4] = {255, 255, 255, 255};
+    glGenTextures(1, &white_texture_);
+    glBindTexture(GL_TEXTURE_2D, white_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    persistent_ = supportsBufferStorage();
+    glGenVertexArrays(1, &vao_);
+    allocate(std::max<std::size_t>(initial_sprites, 64));
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    release();
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteTextures(1, &white_texture_);
+    glDeleteProgram(program_);
+}
+
+void SpriteBatch::release()
+{
+    for (GLsync& fence : fences_) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (mapped_) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped_ = nullptr;
+    }
+    if (vbo_)
+        glDeleteBuffers(1, &vbo_);
+    if (ebo_)
+        glDeleteBuffers(1, &ebo_);
+    vbo_ = 0;
+    ebo_ = 0;
+}
+
+void SpriteBatch::allocate(std::size_t sprites)
+{
+    release();
+    capacity_ = sprites;
+    region_ = 0;
+
+    glBindVertexArray(vao_);
+    glGenBuffers(1, &vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    GLsizeiptr regionBytes = static_cast<GLsizeiptr>(capacity_ * 4 * sizeof(Vertex));
+    if (persistent_) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionBytes * kRegions, nullptr, flags);
+        mapped_ = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes * kRegions, flags));
+        if (!mapped_) {
+            std::cerr << "Persistent mapping failed, falling back to buffer orphaning" << std::endl;
+            persistent_ = false;
+            glDeleteBuffers(1, &vbo_);
+            glGenBuffers(1, &vbo_);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        }
+    }
+    if (!persistent_) {
+        glBufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+    }
+
+    // 所有四边形共用一份静态索引，分区之间用 baseVertex 偏移
+    std::vector<GLuint> indices(capacity_ * 6);
+    for (std::size_t quad = 0; quad < capacity_; ++quad) {
+        auto first = static_cast<GLuint>(quad * 4);
+        GLuint* out = &indices[quad * 6];
+        out[0] = first;
+        out[1] = first + 1;
+        out[2] = first + 2;
+        out[3] = first + 2;
+        out[4] = first + 3;
+        out[5] = first;
+    }
+    glGenBuffers(1, &ebo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)),
+                 indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, circle));
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+}
+
+void SpriteBatch::begin()
+{
+    sprites_.clear();
+}
+
+void SpriteBatch::add(const Sprite& sprite)
+{
+    sprites_.push_back(sprite);
+}
+
+void SpriteBatch::waitRegion(int region)
+{
+    GLsync& fence = fences_[region];
+    if (!fence)
+        return;
+    // 通常三帧前的绘制早已完成，这里几乎不会真正等待
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void SpriteBatch::flush(const glm::mat4& projection)
+{
+    last_sprites_ = sprites_.size();
+    last_draw_calls_ = 0;
+    if (sprites_.empty())
+        return;
+
+    if (sprites_.size() > capacity_) {
+        std::size_t grown = capacity_;
+        while (grown < sprites_.size())
+            grown *= 2;
+        glFinish();  // 旧缓冲里可能还有在途的帧
+        allocate(grown);
+    }
+
+    std::stable_sort(sprites_.begin(), sprites_.end(), [](const Sprite& a, const Sprite& b) {
+        return a.layer != b.layer ? a.layer < b.layer : a.texture < b.texture;
+    });
+
+    staging_.resize(sprites_.size() * 4);
+    Vertex* out = staging_.data();
+    for (const Sprite& sprite : sprites_) {
+        float c = std::cos(sprite.rotation);
+        float s = std::sin(sprite.rotation);
+        const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+        Vertex base{};
+        base.r = toByte(sprite.color.x);
+        base.g = toByte(sprite.color.y);
+        base.b = toByte(sprite.color.z);
+        base.a = toByte(sprite.color.w);
+        base.circle = sprite.circle ? 1.0f : 0.0f;
+        for (const auto& corner : corners) {
+            float lx = corner[0] * sprite.half_size.x;
+            float ly = corner[1] * sprite.half_size.y;
+            Vertex vertex = base;
+            vertex.x = sprite.center.x + lx * c - ly * s;
+            vertex.y = sprite.center.y + lx * s + ly * c;
+            vertex.u = 0.5f + 0.5f * corner[0];
+            vertex.v = 0.5f + 0.5f * corner[1];
+            *out++ = vertex;
+        }
+    }
+
+    std::size_t bytes = staging_.size() * sizeof(Vertex);
+    GLint baseVertex = 0;
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    if (persistent_) {
+        waitRegion(region_);
+        baseVertex = static_cast<GLint>(region_ * capacity_ * 4);
+        std::memcpy(mapped_ + baseVertex, staging_.data(), bytes);
+    } else {
+        // 孤立旧存储，驱动可另分配一块，不必等 GPU 读完上一帧
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity_ * 4 * sizeof(Vertex)), nullptr,
+                     GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), staging_.data());
+    }
+
+    glUseProgram(program_);
+    glUniformMatrix4fv(projection_location_, 1, GL_FALSE, glm::value_ptr(projection));
+    glActiveTexture(GL_TEXTURE0);
+
+    std::size_t runStart = 0;
+    while (runStart < sprites_.size()) {
+        std::size_t runEnd = runStart + 1;
+        while (runEnd < sprites_.size() && sprites_[runEnd].texture == sprites_[runStart].texture)
+            ++runEnd;
+        GLuint texture = sprites_[runStart].texture ? sprites_[runStart].texture : white_texture_;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>((runEnd - runStart) * 6), GL_UNSIGNED_INT,
+                                 (void*)(runStart * 6 * sizeof(GLuint)), baseVertex);
+        ++last_draw_calls_;
+        runStart = runEnd;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+
+    if (persistent_) {
+        fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region_ = (region_ + 1) % kRegions;
+    }
+}
@@ -0,0 +1,170 @@
+#include "table_shards.h"
+
+#include "cpu_topology.h"
+
+#include <utility>
+
+TableShardGroup::TableShardGroup(const ShardOptions& options)
+    : options_(options)
+{
+
+    std::vector<int> shardCpus;
+    if (options_.pin_shards) {
+        shardCpus = assignSeatCpus(detectCpuTopology(), options_.shards);
+    }
+
+    int nextGuest = 0;
+    shards_.reserve(options_.shards);
+    for (int i = 0; i < options_.shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->rng = Pcg32(mixSeed(options_.seed ^ static_cast<std::uint64_t>(i)));
+
+        SimulationOptions simulation = options_.simulation;
+        simulation.mode = ExecutionMode::COROUTINE;
+        simulation.scheduler_cpu = i < static_cast<int>(shardCpus.size()) ? shardCpus[i] : -1;
+        simulation.on_meal = [this, i](int seat) { onMeal(i, seat); };
+        if (simulation.seed != 0)
+            simulation.seed = mixSeed(simulation.seed + static_cast<std::uint64_t>(i));  // 各桌的时长序列互不相同
+        shard->manager = std::make_unique<PhilosopherManager>(options_.seats_per_shard, simulation);
+
+        int seats = shard->manager->getNumPhilosophers();
+        for (int seat = 0; seat < seats; ++seat) {
+            shard->seat_guest.push_back(Guest{nextGuest++, 0});
+        }
+        for (int j = 0; j < options_.lobby_size; ++j) {
+            shard->lobby.push_back(Guest{nextGuest++, 0});
+        }
+        shard->lobby_size.store(options_.lobby_size, std::memory_order_relaxed);
+        shard->seated.store(seats, std::memory_order_relaxed);
+        shards_.push_back(std::move(shard));
+    }
+}
+
+TableShardGroup::~TableShardGroup()
+{
+    stop();
+}
+
+void TableShardGroup::start()
+{
+    for (auto& shard : shards_) {
+        shard->manager->start();
+    }
+}
+
+void TableShardGroup::stop()
+{
+    // 各分片互不等待，逐个停止即可
+    for (auto& shard : shards_) {
+        shard->manager->stop();
+    }
+    // 调度线程都已退出，在本线程收下仍在途中的客人，换出与换入的人数因此相等
+    for (auto& shard : shards_) {
+        if (shard->has_mail.load(std::memory_order_acquire)) {
+            drainMailbox(*shard);
+        }
+    }
+}
+
+int TableShardGroup::getNumShards() const
+{
+    return static_cast<int>(shards_.size());
+}
+
+PhilosopherManager& TableShardGroup::getShard(int index)
+{
+    return *shards_[index]->manager;
+}
+
+ShardStats TableShardGroup::getShardStats(int index) const
+{
+    const Shard& shard = *shards_[index];
+    ShardStats stats;
+    stats.meals = shard.meals.load(std::memory_order_relaxed);
+    stats.migrations_out = shard.migrations_out.load(std::memory_order_relaxed);
+    stats.migrations_in = shard.migrations_in.load(std::memory_order_relaxed);
+    stats.lobby = shard.lobby_size.load(std::memory_order_relaxed);
+    stats.seated = shard.seated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int TableShardGroup::getGuestAt(int shard, int seat) const
+{
+    return shards_[shard]->seat_guest[seat].id;
+}
+
+void TableShardGroup::onMeal(int index, int seat)
+{
+    Shard& shard = *shards_[index];
+    shard.meals.fetch_add(1, std::memory_order_relaxed);
+    ++shard.seat_guest[seat].meals;
+
+    if (shard.has_mail.load(std::memory_order_acquire)) {
+        drainMailbox(shard);
+    }
+
+    if (options_.migration_probability <= 0.0 || shards_.size() < 2)
+        return;
+    // 邮箱只在进餐回调里收取：最后一位客人不能走，否则本桌再也不会进餐，投来的客人全部滞留
+    if (shard.lobby.empty() && shard.seated.load(std::memory_order_relaxed) <= 1)
+        return;
+
+    double roll = shard.rng.uniform01();
+    if (roll >= options_.migration_probability)
+        return;
+
+    // 当前客人离桌去随机的另一张桌子；候座队首补位，没人候座时座位空出，本桌少一个争用者
+    int offset = 1 + static_cast<int>(shard.rng.bounded(static_cast<std::uint32_t>(shards_.size() - 1)));
+    int target = (index + offset) % static_cast<int>(shards_.size());
+    Guest leaving = shard.seat_guest[seat];
+    if (!shard.lobby.empty()) {
+        shard.seat_guest[seat] = shard.lobby.front();
+        shard.lobby.pop_front();
+        shard.lobby_size.store(static_cast<int>(shard.lobby.size()), std::memory_order_relaxed);
+    } else {
+        shard.seat_guest[seat] = Guest{-1, 0};
+        shard.vacant.push_back(seat);
+        shard.manager->setSeatVacant(seat, true);
+        shard.seated.fetch_sub(1, std::memory_order_relaxed);
+    }
+    shard.migrations_out.fetch_add(1, std::memory_order_relaxed);
+    post(target, leaving);
+}
+
+void TableShardGroup::seatGuest(Shard& shard, int seat, const Guest& guest)
+{
+    shard.seat_guest[seat] = guest;
+    shard.manager->setSeatVacant(seat, false);
+    shard.seated.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TableShardGroup::post(int target, const Guest& guest)
+{
+    Shard& shard = *shards_[target];
+    {
+        std::lock_guard<std::mutex> lock(shard.mailbox_mutex);
+        shard.mailbox.push_back(guest);
+    }
+    shard.has_mail.store(true, std::memory_order_release);
+}
+
+void TableShardGroup::drainMailbox(Shard& shard)
+{
+    std::vector<Guest> arrived;
+    {
+        std::lock_guard<std::mutex> lock(shard.mailbox_mutex);
+        arrived.swap(shard.mailbox);
+        shard.has_mail.store(false, std::memory_order_relaxed);
+    }
+    // 新来的客人先坐空座，坐满后再排进候座队列
+    for (const Guest& guest : arrived) {
+        if (!shard.vacant.empty()) {
+            seatGuest(shard, shard.vacant.back(), guest);
+            shard.vacant.pop_back();
+        } else {
+            shard.lobby.push_back(guest);
+        }
+    }
+    shard.lobby_size.store(static_cast<int>(shard.lobby.size()), std::memory_order_relaxed);
+    shard.migrations_in.fetch_add(static_cast<long long>(arrived.size()), std::memory_order_relaxed);
+}
@@ -0,0 +1,159 @@
+#include "text_renderer.h"
+#include "Shader_m.h"
+#include "hud_font.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+constexpr int kAtlasColumns = 16;
+constexpr int kAtlasRows = 6;               // 16 x 6 格：95 个字形加一个实心格
+constexpr int kSolidCell = kHudFontCount;   // 实心格，用来画底板
+constexpr int kAtlasWidth = kAtlasColumns * kHudFontWidth;
+constexpr int kAtlasHeight = kAtlasRows * kHudFontHeight;
+
+std::uint8_t toByte(float value)
+{
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+}  // namespace
+
+TextRenderer::TextRenderer(const std::string& vertex_path, const std::string& fragment_path)
+{
+    Shader shader(vertex_path.c_str(), fragment_path.c_str());
+    program_ = shader.ID;
+    viewport_location_ = glGetUniformLocation(program_, "viewport");
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "atlasSampler"), 0);
+
+    // 把点阵展开成单通道图集
+    std::vector<std::uint8_t> pixels(kAtlasWidth * kAtlasHeight, 0);
+    for (int cell = 0; cell <= kSolidCell; ++cell) {
+        int cx = (cell % kAtlasColumns) * kHudFontWidth;
+        int cy = (cell / kAtlasColumns) * kHudFontHeight;
+        for (int row = 0; row < kHudFontHeight; ++row) {
+            std::uint8_t bits = cell == kSolidCell ? 0xFF : kHudFont[cell][row];
+            for (int col = 0; col < kHudFontWidth; ++col) {
+                if (bits & (0x80 >> col))
+                    pixels[(cy + row) * kAtlasWidth + cx + col] = 255;
+            }
+        }
+    }
+    glGenTextures(1, &atlas_);
+    glBindTexture(GL_TEXTURE_2D, atlas_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kAtlasWidth, kAtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenVertexArrays(1, &vao_);
+    glBindVertexArray(vao_);
+    glGenBuffers(1, &vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+}
+
+TextRenderer::~TextRenderer()
+{
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteTextures(1, &atlas_);
+    glDeleteProgram(program_);
+}
+
+float TextRenderer::glyphWidth(float scale)
+{
+    return kHudFontWidth * scale;
+}
+
+float TextRenderer::lineHeight(float scale)
+{
+    return kHudFontHeight * scale;
+}
+
+void TextRenderer::begin()
+{
+    vertices_.clear();
+}
+
+void TextRenderer::addQuad(float x, float y, float width, float height, int cell, glm::vec4 color)
+{
+    float u0 = static_cast<float>((cell % kAtlasColumns) * kHudFontWidth) / kAtlasWidth;
+    float v0 = static_cast<float>((cell / kAtlasColumns) * kHudFontHeight) / kAtlasHeight;
+    float u1 = u0 + static_cast<float>(kHudFontWidth) / kAtlasWidth;
+    float v1 = v0 + static_cast<float>(kHudFontHeight) / kAtlasHeight;
+
+    Vertex base{};
+    base.r = toByte(color.x);
+    base.g = toByte(color.y);
+    base.b = toByte(color.z);
+    base.a = toByte(color.w);
+    Vertex corners[4] = {base, base, base, base};
+    corners[0].x = x;         corners[0].y = y;          corners[0].u = u0; corners[0].v = v0;
+    corners[1].x = x + width; corners[1].y = y;          corners[1].u = u1; corners[1].v = v0;
+    corners[2].x = x + width; corners[2].y = y + height; corners[2].u = u1; corners[2].v = v1;
+    corners[3].x = x;         corners[3].y = y + height; corners[3].u = u0; corners[3].v = v1;
+    for (int index : {0, 1, 2, 2, 3, 0}) {
+        vertices_.push_back(corners[index]);
+    }
+}
+
+float TextRenderer::addText(float x, float y, std::string_view text, glm::vec4 color, float scale)
+{
+    float cursor = x;
+    float widest = 0.0f;
+    for (char ch : text) {
+        if (ch == '\n') {
+            widest = std::max(widest, cursor - x);
+            cursor = x;
+            y += lineHeight(scale);
+            continue;
+        }
+        int cell = static_cast<unsigned char>(ch) - kHudFontFirst;
+        if (cell > 0 && cell < kHudFontCount)  // 空格和字体外的字符只前进不画
+            addQuad(cursor, y, glyphWidth(scale), lineHeight(scale), cell, color);
+        cursor += glyphWidth(scale);
+    }
+    return std::max(widest, cursor - x);
+}
+
+void TextRenderer::addRect(float x, float y, float width, float height, glm::vec4 color)
+{
+    addQuad(x, y, width, height, kSolidCell, color);
+}
+
+void TextRenderer::flush(int framebuffer_width, int framebuffer_height)
+{
+    if (vertices_.empty())
+        return;
+
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    std::size_t bytes = vertices_.size() * sizeof(Vertex);
+    if (vertices_.size() > capacity_) {
+        capacity_ = std::max(vertices_.size(), capacity_ * 2);
+    }
+    // 每帧孤立旧存储再上传，HUD 只有几千个顶点
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity_ * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), vertices_.data());
+
+    glUseProgram(program_);
+    glUniform2f(viewport_location_, static_cast<float>(framebuffer_width), static_cast<float>(framebuffer_height));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas_);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_.size()));
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,160 @@
+#include "trace_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+}  // namespace
+
+std::shared_ptr<const MappedTrace> MappedTrace::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open trace: " << path << std::endl;
+        return nullptr;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "Trace is empty: " << path << std::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后不再需要描述符
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map trace: " << path << std::endl;
+        return nullptr;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);  // 按顺序回放，让内核预读并及时回收已读页
+
+    std::shared_ptr<const MappedTrace> trace(new MappedTrace(path, static_cast<const char*>(data), size));
+    // 只解析第一条记录：文件里至少有一个合法数值，回放回绕到文件头时总能读到；其余记录读到时再校验
+    std::size_t cursor = 0;
+    std::uint32_t first = 0;
+    std::size_t invalid = 0;
+    switch (trace->parseAt(cursor, first, invalid)) {
+    case Record::VALUE:
+        break;
+    case Record::INVALID:
+        std::cerr << "Trace has an invalid character at byte " << invalid << ": " << path << std::endl;
+        return nullptr;
+    case Record::END:
+        std::cerr << "Trace has no durations: " << path << std::endl;
+        return nullptr;
+    }
+    return trace;
+}
+
+MappedTrace::MappedTrace(std::string path, const char* data, std::size_t size)
+    : path_(std::move(path)), data_(data), size_(size)
+{
+}
+
+MappedTrace::~MappedTrace()
+{
+    munmap(const_cast<char*>(data_), size_);
+}
+
+MappedTrace::Record MappedTrace::parseAt(std::size_t& cursor, std::uint32_t& micros, std::size_t& invalid) const
+{
+    // 跳过空白和注释行
+    while (cursor < size_) {
+        char c = data_[cursor];
+        if (c == '#') {
+            while (cursor < size_ && data_[cursor] != '\n')
+                ++cursor;
+        } else if (isSpace(c)) {
+            ++cursor;
+        } else {
+            break;
+        }
+    }
+    if (cursor >= size_)
+        return Record::END;
+
+    // 一条记录延续到下一个空白；只允许形如 12 / 1.5 / .5 的非负数，
+    // 负号、指数或粘在数字上的其他字符都算错，免得 -5 被读成 5、1e3 被读成 1 和 3
+    std::size_t start = cursor;
+    double ms = 0.0;
+    double scale = 0.0;  // 0 表示还没遇到小数点
+    bool digits = false;
+    invalid = size_;
+    for (; cursor < size_ && !isSpace(data_[cursor]); ++cursor) {
+        char c = data_[cursor];
+        if (isDigit(c)) {
+            digits = true;
+            if (scale == 0.0) {
+                ms = ms * 10.0 + (c - '0');
+            } else {
+                ms += (c - '0') * scale;
+                scale *= 0.1;
+            }
+        } else if (c == '.' && scale == 0.0) {
+            scale = 0.1;
+        } else if (invalid == size_) {
+            invalid = cursor;
+        }
+    }
+    if (!digits && invalid == size_)
+        invalid = start;  // 只有一个小数点
+    if (invalid < size_)
+        return Record::INVALID;
+    double us = std::round(ms * 1000.0);
+    micros = us >= static_cast<double>(std::numeric_limits<std::uint32_t>::max())
+                 ? std::numeric_limits<std::uint32_t>::max()
+                 : static_cast<std::uint32_t>(us);
+    return Record::VALUE;
+}
+
+std::uint32_t MappedTrace::next(std::size_t& cursor) const
+{
+    std::uint32_t micros = 0;
+    std::size_t invalid = 0;
+    for (;;) {
+        switch (parseAt(cursor, micros, invalid)) {
+        case Record::VALUE:
+            return micros;
+        case Record::END:
+            cursor = 0;  // open() 已确认第一条记录合法，回绕后一定能读到
+            break;
+        case Record::INVALID:
+            if (!reported_.exchange(true, std::memory_order_relaxed)) {
+                std::cerr << "Trace has an invalid character at byte " << invalid << ", skipping the record: "
+                          << path_ << std::endl;
+            }
+            break;
+        }
+    }
+}
+
+std::size_t MappedTrace::startCursor(int seat, int seats) const
+{
+    if (seats <= 1 || seat <= 0)
+        return 0;
+    std::size_t cursor = size_ / static_cast<std::size_t>(seats) * static_cast<std::size_t>(seat);
+    if (cursor == 0)
+        return 0;
+    while (cursor < size_ && data_[cursor - 1] != '\n')
+        ++cursor;
+    return cursor < size_ ? cursor : 0;
+}
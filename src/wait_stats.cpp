@@ -0,0 +1,98 @@
+#include "wait_stats.h"
+
+#include <algorithm>
+#include <bit>
+
+WaitRecorder::WaitRecorder(int seats)
+    : seats_(std::make_unique<Seat[]>(seats)),
+      num_seats_(seats)
+{
+}
+
+int WaitRecorder::bucketOf(std::uint64_t micros)
+{
+    if (micros < kSubBuckets)
+        return static_cast<int>(micros);
+    int power = std::bit_width(micros) - 1;  // micros 落在 [2^power, 2^(power+1))
+    int sub = static_cast<int>((micros >> (power - 3)) & (kSubBuckets - 1));
+    int bucket = (power - 2) * kSubBuckets + sub;
+    return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+double WaitRecorder::bucketUpperMs(int bucket)
+{
+    if (bucket < kSubBuckets)
+        return (bucket + 1) / 1000.0;
+    int power = bucket / kSubBuckets + 2;
+    int sub = bucket % kSubBuckets;
+    double lower = static_cast<double>(std::uint64_t{1} << power) * (1.0 + sub / 8.0);
+    return (lower + static_cast<double>(std::uint64_t{1} << (power - 3))) / 1000.0;
+}
+
+void WaitRecorder::record(int seat, std::chrono::nanoseconds wait)
+{
+    auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(wait.count(), 0));
+    Seat& entry = seats_[seat];
+    entry.count.fetch_add(1, std::memory_order_relaxed);
+    entry.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    histogram_[bucketOf(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+
+    std::uint64_t seen = max_ns_.load(std::memory_order_relaxed);
+    while (ns > seen && !max_ns_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t WaitRecorder::count(int seat) const
+{
+    return seats_[seat].count.load(std::memory_order_relaxed);
+}
+
+double WaitRecorder::meanMs(int seat) const
+{
+    std::uint64_t n = count(seat);
+    return n > 0 ? seats_[seat].total_ns.load(std::memory_order_relaxed) / 1e6 / static_cast<double>(n) : 0.0;
+}
+
+WaitSummary WaitRecorder::summary() const
+{
+    WaitSummary result;
+    double totalNs = 0.0;
+    for (int seat = 0; seat < num_seats_; ++seat) {
+        result.samples += seats_[seat].count.load(std::memory_order_relaxed);
+        totalNs += static_cast<double>(seats_[seat].total_ns.load(std::memory_order_relaxed));
+    }
+    if (result.samples == 0)
+        return result;
+    result.mean_ms = totalNs / 1e6 / static_cast<double>(result.samples);
+    result.max_ms = max_ns_.load(std::memory_order_relaxed) / 1e6;
+
+    std::uint64_t histogramTotal = 0;
+    for (const auto& bucket : histogram_) {
+        histogramTotal += bucket.load(std::memory_order_relaxed);
+    }
+    std::uint64_t seen = 0;
+    bool haveP50 = false;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += histogram_[bucket].load(std::memory_order_relaxed);
+        if (!haveP50 && seen * 2 >= histogramTotal) {
+            result.p50_ms = std::min(bucketUpperMs(bucket), result.max_ms);
+            haveP50 = true;
+        }
+        if (seen * 100 >= histogramTotal * 99) {
+            result.p99_ms = std::min(bucketUpperMs(bucket), result.max_ms);
+            break;
+        }
+    }
+    return result;
+}
+
+double jainIndex(std::span<const double> values)
+{
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (double value : values) {
+        sum += value;
+        sumSquares += value * value;
+    }
+    return sumSquares > 0.0 ? sum * sum / (static_cast<double>(values.size()) * sumSquares) : 1.0;
+}
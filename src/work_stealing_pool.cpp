@@ -0,0 +1,231 @@
+#include "work_stealing_pool.h"
+
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+thread_local int tls_worker_index = -1;  // 当前线程在池中的编号，非工作线程为 -1
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(int num_workers,
+                                   int num_seats,
+                                   std::vector<std::atomic<int>>& chopstick_owner,
+                                   StepFunction step)
+    : chopstick_owner_(chopstick_owner),
+      slots_(chopstick_owner.size()),
+      parked_(static_cast<std::size_t>(std::max(num_seats, 0))),
+      step_(std::move(step)),
+      next_worker_(0),
+      epoch_(0),
+      sleepers_(0),
+      stop_(false)
+{
+    workers_.reserve(std::max(num_workers, 1));
+    for (int i = 0; i < std::max(num_workers, 1); ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (auto& parked : parked_) {
+        parked.store(false, std::memory_order_relaxed);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    stop();
+}
+
+void WorkStealingPool::start(const std::vector<int>& worker_cpus)
+{
+    stop_ = false;
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        int cpu = i < worker_cpus.size() ? worker_cpus[i] : -1;
+        workers_[i]->thread = std::thread([this, i, cpu] {
+            if (cpu >= 0)
+                pinCurrentThread(cpu);
+            workerLoop(static_cast<int>(i));
+        });
+    }
+}
+
+void WorkStealingPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        stop_ = true;
+    }
+    idle_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+int WorkStealingPool::getNumWorkers() const
+{
+    return static_cast<int>(workers_.size());
+}
+
+int WorkStealingPool::currentWorker()
+{
+    if (tls_worker_index >= 0)
+        return tls_worker_index;
+    // 主线程上的初始调度按轮转分配，不在热路径上
+    return next_worker_.fetch_add(1, std::memory_order_relaxed) % static_cast<int>(workers_.size());
+}
+
+void WorkStealingPool::scheduleAfter(int seat, std::chrono::milliseconds delay)
+{
+    const bool external = tls_worker_index < 0;
+    Worker& worker = *workers_[currentWorker()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.timers.schedule(Clock::now() + delay, seat);
+    }
+    // 工作线程给自己加定时器时，下一轮循环自然会重新计算等待时间；
+    // 只有外部线程加的定时器才需要叫醒可能正在睡眠的目标线程
+    if (external) {
+        epoch_.fetch_add(1);
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_all();
+    }
+}
+
+void WorkStealingPool::lockSlots(std::span<const int> chopsticks)
+{
+    // 按编号升序加锁，临界区只做检查与登记
+    for (int chopstick : chopsticks) {
+        slots_[chopstick].mutex.lock();
+    }
+}
+
+void WorkStealingPool::unlockSlots(std::span<const int> chopsticks)
+{
+    for (int chopstick : chopsticks) {
+        slots_[chopstick].mutex.unlock();
+    }
+}
+
+bool WorkStealingPool::tryAcquireOrPark(int seat, std::span<const int> chopsticks)
+{
+    lockSlots(chopsticks);
+
+    bool allFree = true;
+    for (int chopstick : chopsticks) {
+        if (chopstick_owner_[chopstick].load(std::memory_order_relaxed) >= 0) {
+            allFree = false;
+            break;
+        }
+    }
+
+    if (allFree) {
+        for (int chopstick : chopsticks) {
+            chopstick_owner_[chopstick].store(seat, std::memory_order_release);
+        }
+    } else {
+        parked_[seat].store(true, std::memory_order_release);
+        for (int chopstick : chopsticks) {
+            if (chopstick_owner_[chopstick].load(std::memory_order_relaxed) >= 0)
+                slots_[chopstick].waiters.push_back(seat);
+        }
+    }
+
+    unlockSlots(chopsticks);
+    return allFree;
+}
+
+void WorkStealingPool::releaseChopsticks(std::span<const int> chopsticks)
+{
+    std::vector<int> woken;
+    lockSlots(chopsticks);
+    for (int chopstick : chopsticks) {
+        chopstick_owner_[chopstick].store(-1, std::memory_order_release);
+        woken.insert(woken.end(), slots_[chopstick].waiters.begin(), slots_[chopstick].waiters.end());
+        slots_[chopstick].waiters.clear();
+    }
+    unlockSlots(chopsticks);
+
+    // 被唤醒的邻居放进放筷子线程自己的队列，它刚碰过这些筷子的缓存行
+    int self = currentWorker();
+    for (int seat : woken) {
+        if (parked_[seat].exchange(false, std::memory_order_acq_rel))
+            pushReady(self, seat);
+    }
+}
+
+void WorkStealingPool::pushReady(int worker, int seat)
+{
+    {
+        std::lock_guard<std::mutex> lock(workers_[worker]->mutex);
+        workers_[worker]->ready.push_back(seat);
+    }
+    epoch_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_one();
+    }
+}
+
+bool WorkStealingPool::popLocal(Worker& worker, int& seat)
+{
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.ready.empty())
+        return false;
+    seat = worker.ready.back();
+    worker.ready.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int thief, int& seat)
+{
+    int count = static_cast<int>(workers_.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *workers_[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.ready.empty()) {
+            seat = victim.ready.front();
+            victim.ready.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+WorkStealingPool::Clock::time_point WorkStealingPool::fireExpiredTimers(Worker& worker)
+{
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.timers.advance(Clock::now(), [&worker](int seat) { worker.ready.push_back(seat); });
+    return worker.timers.nextExpiry();
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    tls_worker_index = index;
+    Worker& self = *workers_[index];
+
+    while (!stop_.load(std::memory_order_acquire)) {
+        std::uint64_t epoch = epoch_.load();
+        Clock::time_point nextDeadline = fireExpiredTimers(self);
+
+        int seat = -1;
+        if (popLocal(self, seat) || steal(index, seat)) {
+            step_(seat);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleepers_.fetch_add(1);
+        auto woke = [this, epoch] { return stop_.load() || epoch_.load() != epoch; };
+        if (nextDeadline == Clock::time_point::max()) {
+            idle_cv_.wait(lock, woke);
+        } else {
+            idle_cv_.wait_until(lock, nextDeadline, woke);
+        }
+        sleepers_.fetch_sub(1);
+    }
+
+    tls_worker_index = -1;
+}